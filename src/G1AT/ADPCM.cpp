@@ -0,0 +1,563 @@
+//
+// Created by Andrej Redeky.
+// Copyright © 2015-2023 Feldarian Softworks. All rights reserved.
+// SPDX-License-Identifier: EUPL-1.2
+//
+
+#include <Precompiled.hpp>
+
+#include "ADPCM.hpp"
+
+namespace
+{
+
+// Blocks handled by single task of parallel decode and encode. Encoding is many times slower than decoding, so its
+// ranges are smaller. Decode ranges hold 32 streams for stereo data, enough to keep AVX2 lanes busy.
+constexpr uint64_t adpcmParallelDecodeBlocks = 16;
+constexpr uint64_t adpcmParallelEncodeBlocks = 4;
+
+// Indices of block ranges handed to parallel algorithms. Owned by the call, so nested and concurrent calls on single
+// thread never share them. One index per range of blocks is few hundred bytes even for the longest batches.
+std::vector<uint64_t> ADPCMParallelRanges(const uint64_t rangesCount)
+{
+  std::vector<uint64_t> ranges(rangesCount);
+  std::iota(ranges.begin(), ranges.end(), 0);
+  return ranges;
+}
+
+int32_t ADPCMDecodeNibble(const uint32_t nibble, int32_t &predictor, int32_t &stepIndex)
+{
+  const auto step = adpcmStepTable[stepIndex];
+
+  auto delta = step >> 3;
+  if (nibble & 1)
+    delta += step >> 2;
+  if (nibble & 2)
+    delta += step >> 1;
+  if (nibble & 4)
+    delta += step;
+
+  predictor = std::clamp((nibble & 8) ? predictor - delta : predictor + delta, -32768, 32767);
+  stepIndex = std::clamp(stepIndex + adpcmIndexTable[nibble], 0, 88);
+
+  return predictor;
+}
+
+uint32_t ADPCMEncodeNibble(const int32_t sample, int32_t &predictor, int32_t &stepIndex)
+{
+  const auto sign = sample < predictor ? 8u : 0u;
+
+  uint32_t bestNibble = sign;
+  auto bestError = std::numeric_limits<int32_t>::max();
+  for (uint32_t magnitude = 0; magnitude < 8; ++magnitude)
+  {
+    auto candidatePredictor = predictor;
+    auto candidateStepIndex = stepIndex;
+    const auto error = std::abs(sample - ADPCMDecodeNibble(sign | magnitude, candidatePredictor, candidateStepIndex));
+    if (error < bestError)
+    {
+      bestError = error;
+      bestNibble = sign | magnitude;
+    }
+  }
+
+  ADPCMDecodeNibble(bestNibble, predictor, stepIndex);
+  return bestNibble;
+}
+
+int32_t ADPCMInitialStepIndex(const int16_t *frames, const uint32_t frameCount, const uint32_t channels)
+{
+  int32_t maxDelta = 0;
+  for (uint32_t frame = 1; frame < std::min(frameCount, 9u); ++frame)
+    maxDelta = std::max(maxDelta, std::abs(frames[frame * channels] - frames[(frame - 1) * channels]));
+
+  const auto stepIt = ranges::lower_bound(adpcmStepTable, maxDelta / 2);
+  return static_cast<int32_t>(std::min<ptrdiff_t>(std::distance(adpcmStepTable.begin(), stepIt), 88));
+}
+
+// Layout of full blocks decoded by vectorized kernels. Stream is single channel of single block, each kernel decodes
+// one stream per lane, so lanes never depend on each other.
+struct ADPCMStreamsLayout
+{
+  const uint8_t *data = nullptr;
+  int16_t *frames = nullptr;
+  uint32_t blockAlign = 0;
+  uint32_t channels = 0;
+  uint32_t samplesPerBlock = 0;
+};
+
+template <size_t Lanes>
+struct ADPCMLanes
+{
+  alignas(32) std::array<int32_t, Lanes> predictors{};
+  alignas(32) std::array<int32_t, Lanes> stepIndices{};
+  std::array<const uint8_t *, Lanes> groupData{};
+  std::array<int16_t *, Lanes> output{};
+
+  ADPCMLanes(const ADPCMStreamsLayout &layout, const size_t firstStream)
+  {
+    for (size_t lane = 0; lane < Lanes; ++lane)
+    {
+      const auto block = (firstStream + lane) / layout.channels;
+      const auto channel = (firstStream + lane) % layout.channels;
+      const auto *blockData = layout.data + block * layout.blockAlign;
+      const auto *header = blockData + channel * 4;
+
+      predictors[lane] = static_cast<int16_t>(header[0] | (header[1] << 8));
+      stepIndices[lane] = std::min<int32_t>(header[2], 88);
+      groupData[lane] = blockData + 4 * layout.channels + channel * 4;
+      output[lane] = layout.frames + block * layout.samplesPerBlock * layout.channels + channel;
+      output[lane][0] = static_cast<int16_t>(predictors[lane]);
+    }
+  }
+
+  int32_t LoadGroup(const size_t lane, const uint32_t group, const uint32_t channels) const
+  {
+    uint32_t nibbles = 0;
+    std::memcpy(&nibbles, groupData[lane] + group * 4 * channels, sizeof(nibbles));
+    return static_cast<int32_t>(nibbles);
+  }
+
+  void Store(const std::array<int32_t, Lanes> &decoded, const size_t frame, const uint32_t channels)
+  {
+    for (size_t lane = 0; lane < Lanes; ++lane)
+      output[lane][frame * channels] = static_cast<int16_t>(decoded[lane]);
+  }
+};
+
+#if G1AT_SIMD_X86
+
+G1AT_TARGET_SSE41 void ADPCMDecodeStreamsSSE41(const ADPCMStreamsLayout &layout, const size_t firstStream)
+{
+  ADPCMLanes<4> lanes(layout, firstStream);
+  alignas(32) std::array<int32_t, 4> decoded{};
+
+  auto predictors = _mm_load_si128(reinterpret_cast<const __m128i *>(lanes.predictors.data()));
+  auto stepIndices = _mm_load_si128(reinterpret_cast<const __m128i *>(lanes.stepIndices.data()));
+
+  const auto one = _mm_set1_epi32(1);
+  const auto three = _mm_set1_epi32(3);
+  const auto seven = _mm_set1_epi32(7);
+  const auto fifteen = _mm_set1_epi32(15);
+  const auto minusOne = _mm_set1_epi32(-1);
+  const auto zero = _mm_setzero_si128();
+  const auto maxStepIndex = _mm_set1_epi32(88);
+  const auto minSample = _mm_set1_epi32(-32768);
+  const auto maxSample = _mm_set1_epi32(32767);
+
+  const auto groupsCount = (layout.samplesPerBlock - 1) / 8;
+  for (uint32_t group = 0; group < groupsCount; ++group)
+  {
+    auto nibbles = _mm_setr_epi32(lanes.LoadGroup(0, group, layout.channels), lanes.LoadGroup(1, group, layout.channels),
+                                  lanes.LoadGroup(2, group, layout.channels), lanes.LoadGroup(3, group, layout.channels));
+
+    for (uint32_t sample = 0; sample < 8; ++sample)
+    {
+      const auto nibble = _mm_and_si128(nibbles, fifteen);
+      nibbles = _mm_srli_epi32(nibbles, 4);
+
+      const auto step = _mm_setr_epi32(adpcmStepTable[_mm_extract_epi32(stepIndices, 0)], adpcmStepTable[_mm_extract_epi32(stepIndices, 1)],
+                                       adpcmStepTable[_mm_extract_epi32(stepIndices, 2)], adpcmStepTable[_mm_extract_epi32(stepIndices, 3)]);
+
+      auto delta = _mm_srai_epi32(step, 3);
+      delta = _mm_add_epi32(delta, _mm_and_si128(_mm_srai_epi32(step, 2), _mm_sub_epi32(zero, _mm_and_si128(nibble, one))));
+      delta = _mm_add_epi32(delta, _mm_and_si128(_mm_srai_epi32(step, 1), _mm_sub_epi32(zero, _mm_and_si128(_mm_srli_epi32(nibble, 1), one))));
+      delta = _mm_add_epi32(delta, _mm_and_si128(step, _mm_sub_epi32(zero, _mm_and_si128(_mm_srli_epi32(nibble, 2), one))));
+
+      const auto sign = _mm_sub_epi32(zero, _mm_srli_epi32(nibble, 3));
+      delta = _mm_sub_epi32(_mm_xor_si128(delta, sign), sign);
+      predictors = _mm_min_epi32(_mm_max_epi32(_mm_add_epi32(predictors, delta), minSample), maxSample);
+
+      const auto magnitude = _mm_and_si128(nibble, seven);
+      const auto indexDelta = _mm_blendv_epi8(minusOne, _mm_slli_epi32(_mm_sub_epi32(magnitude, three), 1), _mm_cmpgt_epi32(magnitude, three));
+      stepIndices = _mm_min_epi32(_mm_max_epi32(_mm_add_epi32(stepIndices, indexDelta), zero), maxStepIndex);
+
+      _mm_store_si128(reinterpret_cast<__m128i *>(decoded.data()), predictors);
+      lanes.Store(decoded, 1 + group * 8 + sample, layout.channels);
+    }
+  }
+}
+
+G1AT_TARGET_AVX2 void ADPCMDecodeStreamsAVX2(const ADPCMStreamsLayout &layout, const size_t firstStream)
+{
+  ADPCMLanes<8> lanes(layout, firstStream);
+  alignas(32) std::array<int32_t, 8> decoded{};
+
+  auto predictors = _mm256_load_si256(reinterpret_cast<const __m256i *>(lanes.predictors.data()));
+  auto stepIndices = _mm256_load_si256(reinterpret_cast<const __m256i *>(lanes.stepIndices.data()));
+
+  const auto one = _mm256_set1_epi32(1);
+  const auto three = _mm256_set1_epi32(3);
+  const auto seven = _mm256_set1_epi32(7);
+  const auto fifteen = _mm256_set1_epi32(15);
+  const auto minusOne = _mm256_set1_epi32(-1);
+  const auto zero = _mm256_setzero_si256();
+  const auto maxStepIndex = _mm256_set1_epi32(88);
+  const auto minSample = _mm256_set1_epi32(-32768);
+  const auto maxSample = _mm256_set1_epi32(32767);
+
+  const auto groupsCount = (layout.samplesPerBlock - 1) / 8;
+  for (uint32_t group = 0; group < groupsCount; ++group)
+  {
+    auto nibbles = _mm256_setr_epi32(lanes.LoadGroup(0, group, layout.channels), lanes.LoadGroup(1, group, layout.channels),
+                                     lanes.LoadGroup(2, group, layout.channels), lanes.LoadGroup(3, group, layout.channels),
+                                     lanes.LoadGroup(4, group, layout.channels), lanes.LoadGroup(5, group, layout.channels),
+                                     lanes.LoadGroup(6, group, layout.channels), lanes.LoadGroup(7, group, layout.channels));
+
+    for (uint32_t sample = 0; sample < 8; ++sample)
+    {
+      const auto nibble = _mm256_and_si256(nibbles, fifteen);
+      nibbles = _mm256_srli_epi32(nibbles, 4);
+
+      const auto step = _mm256_i32gather_epi32(adpcmStepTable.data(), stepIndices, sizeof(int32_t));
+
+      auto delta = _mm256_srai_epi32(step, 3);
+      delta = _mm256_add_epi32(delta, _mm256_and_si256(_mm256_srai_epi32(step, 2), _mm256_sub_epi32(zero, _mm256_and_si256(nibble, one))));
+      delta = _mm256_add_epi32(delta, _mm256_and_si256(_mm256_srai_epi32(step, 1), _mm256_sub_epi32(zero, _mm256_and_si256(_mm256_srli_epi32(nibble, 1), one))));
+      delta = _mm256_add_epi32(delta, _mm256_and_si256(step, _mm256_sub_epi32(zero, _mm256_and_si256(_mm256_srli_epi32(nibble, 2), one))));
+
+      const auto sign = _mm256_sub_epi32(zero, _mm256_srli_epi32(nibble, 3));
+      delta = _mm256_sub_epi32(_mm256_xor_si256(delta, sign), sign);
+      predictors = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(predictors, delta), minSample), maxSample);
+
+      const auto magnitude = _mm256_and_si256(nibble, seven);
+      const auto indexDelta = _mm256_blendv_epi8(minusOne, _mm256_slli_epi32(_mm256_sub_epi32(magnitude, three), 1), _mm256_cmpgt_epi32(magnitude, three));
+      stepIndices = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(stepIndices, indexDelta), zero), maxStepIndex);
+
+      _mm256_store_si256(reinterpret_cast<__m256i *>(decoded.data()), predictors);
+      lanes.Store(decoded, 1 + group * 8 + sample, layout.channels);
+    }
+  }
+}
+
+#elif G1AT_SIMD_NEON
+
+void ADPCMDecodeStreamsNEON(const ADPCMStreamsLayout &layout, const size_t firstStream)
+{
+  ADPCMLanes<4> lanes(layout, firstStream);
+  alignas(32) std::array<int32_t, 4> decoded{};
+
+  auto predictors = vld1q_s32(lanes.predictors.data());
+  auto stepIndices = vld1q_s32(lanes.stepIndices.data());
+
+  const auto one = vdupq_n_s32(1);
+  const auto three = vdupq_n_s32(3);
+  const auto seven = vdupq_n_s32(7);
+  const auto fifteen = vdupq_n_s32(15);
+  const auto minusOne = vdupq_n_s32(-1);
+  const auto zero = vdupq_n_s32(0);
+  const auto maxStepIndex = vdupq_n_s32(88);
+  const auto minSample = vdupq_n_s32(-32768);
+  const auto maxSample = vdupq_n_s32(32767);
+
+  const auto groupsCount = (layout.samplesPerBlock - 1) / 8;
+  for (uint32_t group = 0; group < groupsCount; ++group)
+  {
+    alignas(16) const std::array<int32_t, 4> groupNibbles{lanes.LoadGroup(0, group, layout.channels), lanes.LoadGroup(1, group, layout.channels),
+                                                          lanes.LoadGroup(2, group, layout.channels), lanes.LoadGroup(3, group, layout.channels)};
+    auto nibbles = vreinterpretq_u32_s32(vld1q_s32(groupNibbles.data()));
+
+    for (uint32_t sample = 0; sample < 8; ++sample)
+    {
+      const auto nibble = vreinterpretq_s32_u32(vandq_u32(nibbles, vreinterpretq_u32_s32(fifteen)));
+      nibbles = vshrq_n_u32(nibbles, 4);
+
+      alignas(16) const std::array<int32_t, 4> steps{adpcmStepTable[vgetq_lane_s32(stepIndices, 0)], adpcmStepTable[vgetq_lane_s32(stepIndices, 1)],
+                                                     adpcmStepTable[vgetq_lane_s32(stepIndices, 2)], adpcmStepTable[vgetq_lane_s32(stepIndices, 3)]};
+      const auto step = vld1q_s32(steps.data());
+
+      auto delta = vshrq_n_s32(step, 3);
+      delta = vaddq_s32(delta, vandq_s32(vshrq_n_s32(step, 2), vnegq_s32(vandq_s32(nibble, one))));
+      delta = vaddq_s32(delta, vandq_s32(vshrq_n_s32(step, 1), vnegq_s32(vandq_s32(vshrq_n_s32(nibble, 1), one))));
+      delta = vaddq_s32(delta, vandq_s32(step, vnegq_s32(vandq_s32(vshrq_n_s32(nibble, 2), one))));
+
+      const auto sign = vnegq_s32(vshrq_n_s32(nibble, 3));
+      delta = vsubq_s32(veorq_s32(delta, sign), sign);
+      predictors = vminq_s32(vmaxq_s32(vaddq_s32(predictors, delta), minSample), maxSample);
+
+      const auto magnitude = vandq_s32(nibble, seven);
+      const auto indexDelta = vbslq_s32(vcgtq_s32(magnitude, three), vshlq_n_s32(vsubq_s32(magnitude, three), 1), minusOne);
+      stepIndices = vminq_s32(vmaxq_s32(vaddq_s32(stepIndices, indexDelta), zero), maxStepIndex);
+
+      vst1q_s32(decoded.data(), predictors);
+      lanes.Store(decoded, 1 + group * 8 + sample, layout.channels);
+    }
+  }
+}
+
+#endif
+
+template <uint32_t Channels>
+uint32_t ADPCMDecodeBlockImpl(const std::span<const char> &block, const uint32_t runtimeChannels, int16_t *frames, const uint32_t maxFrames)
+{
+  const auto channels = Channels != 0 ? Channels : runtimeChannels;
+
+  std::array<int32_t, Channels != 0 ? Channels : 8> predictors{};
+  std::array<int32_t, Channels != 0 ? Channels : 8> stepIndices{};
+  if (channels == 0 || channels > predictors.size() || maxFrames == 0 || block.size() < 4 * channels)
+    return 0;
+
+  const auto *blockData = reinterpret_cast<const uint8_t *>(block.data());
+
+  for (uint32_t channel = 0; channel < channels; ++channel)
+  {
+    const auto *header = blockData + channel * 4;
+    predictors[channel] = static_cast<int16_t>(header[0] | (header[1] << 8));
+    stepIndices[channel] = std::min<int32_t>(header[2], 88);
+    frames[channel] = static_cast<int16_t>(predictors[channel]);
+  }
+
+  const auto groupsCount = static_cast<uint32_t>((block.size() - 4 * channels) / (4 * channels));
+  const auto framesCount = std::min(maxFrames, 1 + groupsCount * 8);
+
+  const auto *groupData = blockData + 4 * channels;
+  for (uint32_t group = 0; group < groupsCount; ++group)
+  {
+    for (uint32_t channel = 0; channel < channels; ++channel)
+    {
+      const auto *channelData = groupData + (group * channels + channel) * 4;
+      for (uint32_t sample = 0; sample < 8; ++sample)
+      {
+        const auto frame = 1 + group * 8 + sample;
+        const auto nibble = (channelData[sample / 2] >> ((sample % 2) * 4)) & 0x0F;
+        const auto decoded = ADPCMDecodeNibble(nibble, predictors[channel], stepIndices[channel]);
+        if (frame < framesCount)
+          frames[frame * channels + channel] = static_cast<int16_t>(decoded);
+      }
+    }
+  }
+
+  return framesCount;
+}
+
+template <uint32_t Channels>
+uint32_t ADPCMEncodeBlockImpl(const int16_t *frames, const uint32_t frameCount, const uint32_t runtimeChannels, char *block, int16_t *reconstructed)
+{
+  const auto channels = Channels != 0 ? Channels : runtimeChannels;
+
+  if (channels == 0 || frameCount == 0)
+    return 0;
+
+  auto *blockData = reinterpret_cast<uint8_t *>(block);
+  const auto blockSize = ADPCMBlockSize(frameCount, channels);
+  std::memset(blockData, 0, blockSize);
+
+  const auto groupsCount = (frameCount - 1 + 7) / 8;
+  for (uint32_t channel = 0; channel < channels; ++channel)
+  {
+    int32_t predictor = frames[channel];
+    auto stepIndex = ADPCMInitialStepIndex(frames + channel, frameCount, channels);
+
+    auto *header = blockData + channel * 4;
+    header[0] = static_cast<uint8_t>(predictor & 0xFF);
+    header[1] = static_cast<uint8_t>((predictor >> 8) & 0xFF);
+    header[2] = static_cast<uint8_t>(stepIndex);
+    header[3] = 0;
+
+    if (reconstructed)
+      reconstructed[channel] = static_cast<int16_t>(predictor);
+
+    for (uint32_t group = 0; group < groupsCount; ++group)
+    {
+      auto *channelData = blockData + 4 * channels + (group * channels + channel) * 4;
+      for (uint32_t sample = 0; sample < 8; ++sample)
+      {
+        const auto frame = 1 + group * 8 + sample;
+
+        // NOTE - padding at the end of last block repeats last sample, decoders never output it
+        const auto input = frames[std::min(frame, frameCount - 1) * channels + channel];
+        const auto nibble = ADPCMEncodeNibble(input, predictor, stepIndex);
+        channelData[sample / 2] |= static_cast<uint8_t>(nibble << ((sample % 2) * 4));
+
+        if (reconstructed && frame < frameCount)
+          reconstructed[frame * channels + channel] = static_cast<int16_t>(predictor);
+      }
+    }
+  }
+
+  return blockSize;
+}
+
+// Block codecs specialized for mono and stereo, so their channel loops have constant trip counts.
+struct ADPCMBlockCodec
+{
+  uint32_t (*decodeBlock)(const std::span<const char> &, uint32_t, int16_t *, uint32_t);
+  uint32_t (*encodeBlock)(const int16_t *, uint32_t, uint32_t, char *, int16_t *);
+};
+
+constexpr std::array<ADPCMBlockCodec, 3> adpcmBlockCodecs{{
+  {ADPCMDecodeBlockImpl<0>, ADPCMEncodeBlockImpl<0>},
+  {ADPCMDecodeBlockImpl<1>, ADPCMEncodeBlockImpl<1>},
+  {ADPCMDecodeBlockImpl<2>, ADPCMEncodeBlockImpl<2>},
+}};
+
+const ADPCMBlockCodec &GetADPCMBlockCodec(const uint32_t channels)
+{
+  return adpcmBlockCodecs[channels < adpcmBlockCodecs.size() ? channels : 0];
+}
+
+}
+
+uint32_t ADPCMSamplesPerBlock(const uint32_t blockAlign, const uint32_t channels)
+{
+  if (channels == 0 || blockAlign < 4 * channels)
+    return 0;
+
+  return (blockAlign - 4 * channels) * 2 / channels + 1;
+}
+
+uint32_t ADPCMBlockAlign(const uint32_t samplesPerBlock, const uint32_t channels)
+{
+  return ADPCMBlockSize(samplesPerBlock, channels);
+}
+
+uint32_t ADPCMBlockSize(const uint32_t frames, const uint32_t channels)
+{
+  if (frames == 0)
+    return 0;
+
+  return 4 * channels + (frames - 1 + 7) / 8 * 4 * channels;
+}
+
+uint32_t ADPCMDecodeBlock(const std::span<const char> &block, const uint32_t channels, int16_t *frames, const uint32_t maxFrames)
+{
+  return GetADPCMBlockCodec(channels).decodeBlock(block, channels, frames, maxFrames);
+}
+
+uint32_t ADPCMEncodeBlock(const int16_t *frames, const uint32_t frameCount, const uint32_t channels, char *block, int16_t *reconstructed)
+{
+  return GetADPCMBlockCodec(channels).encodeBlock(frames, frameCount, channels, block, reconstructed);
+}
+
+uint64_t ADPCMDecodeBlocks(const std::span<const char> &data, const uint32_t blockAlign, const uint32_t channels, int16_t *frames, const uint64_t maxFrames,
+                           const SIMDLevel simdLevel)
+{
+  const auto samplesPerBlock = ADPCMSamplesPerBlock(blockAlign, channels);
+  if (samplesPerBlock == 0)
+    return 0;
+
+  void (*decodeStreams)(const ADPCMStreamsLayout &, size_t) = nullptr;
+  size_t lanesCount = 0;
+  switch (GetSIMDLevel(simdLevel))
+  {
+#if G1AT_SIMD_X86
+    case SIMDLevel::AVX2: {
+      decodeStreams = ADPCMDecodeStreamsAVX2;
+      lanesCount = 8;
+      break;
+    }
+    case SIMDLevel::SSE41: {
+      decodeStreams = ADPCMDecodeStreamsSSE41;
+      lanesCount = 4;
+      break;
+    }
+#elif G1AT_SIMD_NEON
+    case SIMDLevel::NEON: {
+      decodeStreams = ADPCMDecodeStreamsNEON;
+      lanesCount = 4;
+      break;
+    }
+#endif
+    default: {
+      break;
+    }
+  }
+
+  uint64_t blocksCount = 0;
+  if (decodeStreams && lanesCount % channels == 0)
+  {
+    const auto blocksPerBatch = lanesCount / channels;
+    const auto fullBlocksCount = std::min<uint64_t>(data.size() / blockAlign, maxFrames / samplesPerBlock);
+    blocksCount = fullBlocksCount / blocksPerBatch * blocksPerBatch;
+
+    const ADPCMStreamsLayout layout{reinterpret_cast<const uint8_t *>(data.data()), frames, blockAlign, channels, samplesPerBlock};
+    for (uint64_t stream = 0; stream < blocksCount * channels; stream += lanesCount)
+      decodeStreams(layout, stream);
+  }
+
+  const auto &blockCodec = GetADPCMBlockCodec(channels);
+  auto framesCount = blocksCount * samplesPerBlock;
+  auto dataOffset = blocksCount * blockAlign;
+  while (dataOffset < data.size() && framesCount < maxFrames)
+  {
+    const auto blockSize = std::min<size_t>(blockAlign, data.size() - dataOffset);
+    const auto blockFrames = blockCodec.decodeBlock(data.subspan(dataOffset, blockSize), channels, frames + framesCount * channels,
+                                              static_cast<uint32_t>(std::min<uint64_t>(maxFrames - framesCount, samplesPerBlock)));
+    if (blockFrames == 0)
+      break;
+
+    framesCount += blockFrames;
+    dataOffset += blockSize;
+  }
+
+  return framesCount;
+}
+
+uint64_t ADPCMDecodeBlocksParallel(const std::span<const char> &data, const uint32_t blockAlign, const uint32_t channels, int16_t *frames,
+                                   const uint64_t maxFrames, const SIMDLevel simdLevel)
+{
+  const auto samplesPerBlock = ADPCMSamplesPerBlock(blockAlign, channels);
+  if (samplesPerBlock == 0)
+    return 0;
+
+  const auto blocksCount = std::min((data.size() + blockAlign - 1) / blockAlign, (maxFrames + samplesPerBlock - 1) / samplesPerBlock);
+  const auto rangesCount = (blocksCount + adpcmParallelDecodeBlocks - 1) / adpcmParallelDecodeBlocks;
+  if (rangesCount < 2)
+    return ADPCMDecodeBlocks(data, blockAlign, channels, frames, maxFrames, simdLevel);
+
+  // NOTE - only the last block may be truncated, so all ranges but the last one are always complete
+  uint64_t lastRangeFrames = 0;
+  const auto ranges = ADPCMParallelRanges(rangesCount);
+  std::for_each(std::execution::par, ranges.begin(), ranges.end(), [&](const uint64_t range) {
+    const auto firstBlock = range * adpcmParallelDecodeBlocks;
+    const auto firstFrame = firstBlock * samplesPerBlock;
+    const auto rangeData = data.subspan(firstBlock * blockAlign, std::min<size_t>(adpcmParallelDecodeBlocks * blockAlign, data.size() - firstBlock * blockAlign));
+    const auto rangeFrames = ADPCMDecodeBlocks(rangeData, blockAlign, channels, frames + firstFrame * channels,
+                                               std::min(adpcmParallelDecodeBlocks * samplesPerBlock, maxFrames - firstFrame), simdLevel);
+    if (range == rangesCount - 1)
+      lastRangeFrames = rangeFrames;
+  });
+
+  return (rangesCount - 1) * adpcmParallelDecodeBlocks * samplesPerBlock + lastRangeFrames;
+}
+
+uint64_t ADPCMEncodeBlocks(const int16_t *frames, const uint64_t frameCount, const uint32_t channels, const uint32_t blockAlign, char *data,
+                           int16_t *reconstructed)
+{
+  const auto samplesPerBlock = ADPCMSamplesPerBlock(blockAlign, channels);
+  if (samplesPerBlock == 0 || frameCount == 0)
+    return 0;
+
+  const auto &blockCodec = GetADPCMBlockCodec(channels);
+  uint64_t dataSize = 0;
+  for (uint64_t firstFrame = 0; firstFrame < frameCount; firstFrame += samplesPerBlock)
+  {
+    dataSize += blockCodec.encodeBlock(frames + firstFrame * channels, static_cast<uint32_t>(std::min<uint64_t>(samplesPerBlock, frameCount - firstFrame)),
+                                       channels, data + dataSize, reconstructed ? reconstructed + firstFrame * channels : nullptr);
+  }
+
+  return dataSize;
+}
+
+uint64_t ADPCMEncodeBlocksParallel(const int16_t *frames, const uint64_t frameCount, const uint32_t channels, const uint32_t blockAlign, char *data,
+                                   int16_t *reconstructed)
+{
+  const auto samplesPerBlock = ADPCMSamplesPerBlock(blockAlign, channels);
+  if (samplesPerBlock == 0 || frameCount == 0)
+    return 0;
+
+  const auto blocksCount = (frameCount + samplesPerBlock - 1) / samplesPerBlock;
+  const auto rangesCount = (blocksCount + adpcmParallelEncodeBlocks - 1) / adpcmParallelEncodeBlocks;
+  if (rangesCount < 2)
+    return ADPCMEncodeBlocks(frames, frameCount, channels, blockAlign, data, reconstructed);
+
+  // NOTE - only the last block may be truncated, so all ranges but the last one are always complete
+  const auto ranges = ADPCMParallelRanges(rangesCount);
+  std::for_each(std::execution::par, ranges.begin(), ranges.end(), [&](const uint64_t range) {
+    const auto firstFrame = range * adpcmParallelEncodeBlocks * samplesPerBlock;
+    ADPCMEncodeBlocks(frames + firstFrame * channels, std::min(adpcmParallelEncodeBlocks * samplesPerBlock, frameCount - firstFrame), channels, blockAlign,
+                      data + range * adpcmParallelEncodeBlocks * blockAlign, reconstructed ? reconstructed + firstFrame * channels : nullptr);
+  });
+
+  return (blocksCount - 1) * blockAlign + ADPCMBlockSize(static_cast<uint32_t>(frameCount - (blocksCount - 1) * samplesPerBlock), channels);
+}
@@ -0,0 +1,59 @@
+//
+// Created by Andrej Redeky.
+// Copyright © 2015-2023 Feldarian Softworks. All rights reserved.
+// SPDX-License-Identifier: EUPL-1.2
+//
+// Block codec for IMA ADPCM in the Microsoft WAV layout (format tag 0x11), which is what all Glacier 1 games use.
+// Every block starts with 4 byte header per channel (first sample and step index), followed by groups of 4 bytes
+// (8 samples) per channel, interleaved channel by channel. Lower nibble of each byte holds the earlier sample.
+//
+
+#pragma once
+
+#include "SIMD.hpp"
+
+inline constexpr std::array<int32_t, 89> adpcmStepTable{
+  7,     8,     9,     10,    11,    12,    13,    14,    16,    17,    19,    21,    23,    25,    28,
+  31,    34,    37,    41,    45,    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+  130,   143,   157,   173,   190,   209,   230,   253,   279,   307,   337,   371,   408,   449,   494,
+  544,   598,   658,   724,   796,   876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+  2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,  7132,  7845,  8630,
+  9493,  10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+inline constexpr std::array<int32_t, 16> adpcmIndexTable{-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+
+uint32_t ADPCMSamplesPerBlock(uint32_t blockAlign, uint32_t channels);
+
+uint32_t ADPCMBlockAlign(uint32_t samplesPerBlock, uint32_t channels);
+
+// Size of the block holding given amount of frames, smaller than block align only for the last block of the stream.
+uint32_t ADPCMBlockSize(uint32_t frames, uint32_t channels);
+
+// Decodes single block, which may be truncated, into interleaved frames. Returns number of written frames.
+uint32_t ADPCMDecodeBlock(const std::span<const char> &block, uint32_t channels, int16_t *frames, uint32_t maxFrames);
+
+// Encodes up to single block of interleaved frames, returns number of written bytes. Initial step index of each block
+// is derived only from its own samples, so every block can be encoded independently of the rest of the stream.
+// When reconstructed is not null, it receives frames exactly as any decoder will see them.
+uint32_t ADPCMEncodeBlock(const int16_t *frames, uint32_t frameCount, uint32_t channels, char *block, int16_t *reconstructed = nullptr);
+
+// Decodes as many blocks as fit into maxFrames. Full blocks are decoded several at once, one channel of one block per
+// SIMD lane, with output identical to ADPCMDecodeBlock. Returns number of written frames.
+uint64_t ADPCMDecodeBlocks(const std::span<const char> &data, uint32_t blockAlign, uint32_t channels, int16_t *frames, uint64_t maxFrames,
+                           SIMDLevel simdLevel = GetSIMDLevel());
+
+// Same as ADPCMDecodeBlocks, but ranges of blocks are decoded on multiple threads when there are enough of them.
+// NOTE - callers already running inside parallel loop, or holding per-thread scratch buffers, use ADPCMDecodeBlocks,
+//        as waiting for the nested loop may run other tasks of the outer loop on the calling thread.
+uint64_t ADPCMDecodeBlocksParallel(const std::span<const char> &data, uint32_t blockAlign, uint32_t channels, int16_t *frames, uint64_t maxFrames,
+                                   SIMDLevel simdLevel = GetSIMDLevel());
+
+// Encodes interleaved frames into consecutive blocks, output is identical to encoding the blocks one by one.
+// Returns number of written bytes.
+uint64_t ADPCMEncodeBlocks(const int16_t *frames, uint64_t frameCount, uint32_t channels, uint32_t blockAlign, char *data, int16_t *reconstructed = nullptr);
+
+// Same as ADPCMEncodeBlocks, but ranges of blocks are encoded on multiple threads when there are enough of them.
+// Same restrictions as for ADPCMDecodeBlocksParallel apply.
+uint64_t ADPCMEncodeBlocksParallel(const int16_t *frames, uint64_t frameCount, uint32_t channels, uint32_t blockAlign, char *data,
+                                   int16_t *reconstructed = nullptr);
@@ -152,10 +152,15 @@ void ArchiveDirectory::CleanOriginal()
     file.original = true;
 }
 
-void ArchiveDirectory::DrawTree(const StringView8CI &thisPath) const
+void ArchiveDirectory::DrawTree(ArchiveDialog &archiveDialog, const StringView8CI &thisPath) const
 {
-  if (!thisPath.empty() && !ImGui::TreeNode(String8(thisPath).c_str()))
-    return;
+  if (!thisPath.empty())
+  {
+    if (!ImGui::TreeNode(String8(thisPath).c_str()))
+      return;
+
+    archiveDialog.OnDirectoryOpened(*this);
+  }
 
   for (const auto& [directoryPath, directory] : directories)
   {
@@ -164,7 +169,7 @@ void ArchiveDirectory::DrawTree(const StringView8CI &thisPath) const
     else if (!directory.IsOriginal())
       ImGui::PushStyleColor(ImGuiCol_Text, ImVec4{0.0f, 1.0f, 0.0f, 1.0f});
 
-    directory.DrawTree(directoryPath);
+    directory.DrawTree(archiveDialog, directoryPath);
 
     if (directory.IsDirty() || !directory.IsOriginal())
       ImGui::PopStyleColor();
@@ -277,15 +282,34 @@ bool ArchiveDialog::Import(const StringView8CI &importFolderPath)
     progressNextTotal = allImportFiles.size();
     progressNext = 0;
 
-    std::for_each(std::execution::par, allImportFiles.begin(), allImportFiles.end(), [this, importFolderPath, options](const auto& importFilePath)
+    // NOTE - largest files are imported first, so long encodes do not end up as the tail of the whole batch
+    std::vector<std::pair<uintmax_t, const String8CI *>> importFilesBySize;
+    importFilesBySize.reserve(allImportFiles.size());
+    for (const auto &importFilePath : allImportFiles)
     {
+      std::error_code errorCode;
+      const auto importFileSize = file_size(importFilePath.path(), errorCode);
+      importFilesBySize.emplace_back(errorCode ? 0 : importFileSize, &importFilePath);
+    }
+    ranges::stable_sort(importFilesBySize, std::greater{}, [](const auto &importFileBySize) { return importFileBySize.first; });
+
+    // NOTE - workers pull files from shared queue, splitting the sorted list into fixed ranges would undo the ordering
+    std::atomic_size_t nextImportFile = 0;
+    std::vector<size_t> importWorkers(std::max(std::thread::hardware_concurrency(), 1u));
+    std::for_each(std::execution::par, importWorkers.begin(), importWorkers.end(), [this, importFolderPath, options, &importFilesBySize, &nextImportFile](auto&)
+    {
+      for (auto importFile = nextImportFile++; importFile < importFilesBySize.size(); importFile = nextImportFile++)
       {
-        std::unique_lock progressMessageLock(progressMessageMutex);
-        progressMessage = g_LocalizationManager.LocalizeFormat("ARCHIVE_DIALOG_IMPORT_PROGRESS_IMPORTING_FILE", String8(relative(importFilePath.path(), importFolderPath.path())));
-        ++progressNext;
-      }
+        const auto &importFilePath = *importFilesBySize[importFile].second;
 
-      ImportSingle(importFolderPath, importFilePath, options);
+        {
+          std::unique_lock progressMessageLock(progressMessageMutex);
+          progressMessage = g_LocalizationManager.LocalizeFormat("ARCHIVE_DIALOG_IMPORT_PROGRESS_IMPORTING_FILE", String8(relative(importFilePath.path(), importFolderPath.path())));
+          ++progressNext;
+        }
+
+        ImportSingle(importFolderPath, importFilePath, options);
+      }
     });
 
     std::unique_lock progressMessageLock(progressMessageMutex);
@@ -313,6 +337,15 @@ bool ArchiveDialog::Export(const StringView8CI &exportFolderPathView)
       return;
     }
 
+    if (!LoadDeferredData(options) || !ResolvePendingImports(options))
+    {
+      DisplayError(g_LocalizationManager.Localize("ARCHIVE_DIALOG_EXPORT_ERROR_PREPARING_DATA"));
+
+      std::unique_lock progressMessageLock(progressMessageMutex);
+      progressMessage.clear();
+      return;
+    }
+
     progressNextTotal = archivePaths.size();
     progressNext = 0;
 
@@ -356,6 +389,15 @@ bool ArchiveDialog::Save(const StringView8CI &savePath, bool async)
       return;
     }
 
+    if (!ResolvePendingImports(options))
+    {
+      DisplayError(g_LocalizationManager.Localize("ARCHIVE_DIALOG_SAVE_ERROR_PREPARING_DATA"));
+
+      std::unique_lock progressMessageLock(progressMessageMutex);
+      progressMessage.clear();
+      return;
+    }
+
     if (SaveImpl(nextPath, options))
       path = nextPath;
 
@@ -372,6 +414,20 @@ bool ArchiveDialog::Save(const StringView8CI &savePath, bool async)
   return true;
 }
 
+bool ArchiveDialog::ResolvePendingImports(const Options &)
+{
+  return true;
+}
+
+bool ArchiveDialog::LoadDeferredData(const Options &)
+{
+  return true;
+}
+
+void ArchiveDialog::OnDirectoryOpened(const ArchiveDirectory &)
+{
+}
+
 int32_t ArchiveDialog::UnsavedChangesPopup() const
 {
   if (!archiveRoot.IsDirty())
@@ -510,7 +566,7 @@ int32_t ArchiveDialog::DrawBaseDialog()
   else if (!archivePath.empty())
   {
     if (ImGui::BeginChild("##FileList", {}, false, ImGuiWindowFlags_HorizontalScrollbar))
-      archiveRoot.DrawTree();
+      archiveRoot.DrawTree(*this);
 
     ImGui::EndChild();
   }
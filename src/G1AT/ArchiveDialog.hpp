@@ -8,6 +8,8 @@
 
 #include "Options.hpp"
 
+class ArchiveDialog;
+
 struct ArchiveFile
 {
   bool dirty = false;
@@ -31,7 +33,7 @@ public:
   void CleanDirty();
   void CleanOriginal();
 
-  void DrawTree(const StringView8CI &thisPath = "") const;
+  void DrawTree(ArchiveDialog &archiveDialog, const StringView8CI &thisPath = "") const;
 
 private:
   ArchiveDirectory& GetDirectory(std::vector<StringView8CI>& pathStems, StringView8CI searchPath, OrderedSet<String8CI>& archivePaths);
@@ -59,6 +61,12 @@ public:
   bool Export(const StringView8CI &exportFolderPath);
 
   virtual bool SaveImpl(const StringView8CI &savePath, const Options &options) = 0;
+  // Finishes work deferred by imports, called before archive is saved or exported.
+  virtual bool ResolvePendingImports(const Options &options);
+  // Loads data which was not needed when archive was opened, called before archive is exported.
+  virtual bool LoadDeferredData(const Options &options);
+  // Called for every directory which is expanded in the tree view, each time the tree is drawn.
+  virtual void OnDirectoryOpened(const ArchiveDirectory &directory);
   bool Save(const StringView8CI &savePath, bool async);
 
   int32_t UnsavedChangesPopup() const;
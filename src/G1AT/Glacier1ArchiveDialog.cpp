@@ -8,10 +8,60 @@
 
 #include "Glacier1ArchiveDialog.hpp"
 
+#include "Transcode.hpp"
 #include "Utils.hpp"
 
-// TODO - use spans like in PCMS16 which are resized to max. required capacity before use and optimize a bit calling of this that way
-//        or even better, try to upgrade to std::ranges or views
+namespace
+{
+
+// Lowest of the common sample rates which is not lower than the given one, 0 when there is none.
+uint32_t PlayableSampleRate(const uint32_t sampleRate)
+{
+  static const OrderedSet<uint32_t> normalSampleRates{11025, 22050, 44100, 48000};
+  const auto normalSampleRateIt = ranges::lower_bound(normalSampleRates, sampleRate);
+  return normalSampleRateIt == normalSampleRates.end() ? 0 : *normalSampleRateIt;
+}
+
+}
+
+std::shared_ptr<const Glacier1ImportSource> Glacier1ImportSource::Get(const AudioDataInfo &soundRecord, const std::span<const char> &soundDataView)
+{
+  static std::mutex importSourcesMutex;
+  static OrderedMap<uint64_t, std::weak_ptr<const Glacier1ImportSource>> importSources;
+  static size_t importSourcesPruneSize = 64;
+
+  {
+    std::unique_lock importSourcesLock(importSourcesMutex);
+    const auto importSourceIt = importSources.find(soundRecord.dataXXH3);
+    if (importSourceIt != importSources.end())
+    {
+      if (auto importSource = importSourceIt->second.lock())
+        return importSource;
+    }
+  }
+
+  auto newImportSource = std::make_shared<const Glacier1ImportSource>(
+      Glacier1ImportSource{soundRecord, {soundDataView.data(), soundDataView.data() + soundRecord.dataSize}});
+
+  std::unique_lock importSourcesLock(importSourcesMutex);
+  auto &importSource = importSources[soundRecord.dataXXH3];
+  if (auto sharedImportSource = importSource.lock())
+    return sharedImportSource;
+
+  importSource = newImportSource;
+
+  // NOTE - sources of resolved imports are dropped once in a while, so the map does not grow with every import ever made
+  if (importSources.size() >= importSourcesPruneSize)
+  {
+    for (auto importSourceIt = importSources.begin(); importSourceIt != importSources.end();)
+      importSourceIt = importSourceIt->second.expired() ? importSources.erase(importSourceIt) : std::next(importSourceIt);
+
+    importSourcesPruneSize = std::max<size_t>(64, importSources.size() * 2);
+  }
+
+  return newImportSource;
+}
+
 bool Glacier1AudioFile::Import(AudioDataInfo soundRecord, const std::span<const char> &soundDataView, const Options &options)
 {
   if (!soundRecord.dataSize || soundDataView.size() < soundRecord.dataSize)
@@ -20,74 +70,44 @@ bool Glacier1AudioFile::Import(AudioDataInfo soundRecord, const std::span<const
   if (options.common.directImport)
     return ImportNative(soundRecord, soundDataView, true, options);
 
-  std::vector<int16_t> pcms16Decoded;
-  if (!PCMS16FromSoundData(soundRecord, soundDataView, pcms16Decoded, AudioConversionFlag::RAWOutput))
+  soundRecord.dataXXH3 = PCMS16SoundDataXXH3(soundRecord, soundDataView);
+  if (soundRecord.dataXXH3 == 0)
     return false;
 
-  soundRecord.dataXXH3 = XXH3_64bits(pcms16Decoded.data(), pcms16Decoded.size() * sizeof(int16_t));
-
   if (!options.common.importSameFiles && (archiveRecord.dataXXH3 == soundRecord.dataXXH3))
+  {
+    pendingImport.reset();
+    importSourceXXH3 = 0;
     return true;
+  }
 
-  bool fixedData = false;
-  auto fixedHeader = PCMS16Header(soundRecord);
+  TranscodeFormat targetFormat{AudioDataFormat::PCM_S16, soundRecord.sampleRate, soundRecord.channels};
+  targetFormat.resamplerQuality = options.common.resamplerQuality;
+  targetFormat.vorbisQuality = options.common.vorbisQuality;
 
   if (options.common.fixChannels)
-  {
-    const auto result = PCMS16ChangeChannelCount(fixedHeader, pcms16Decoded, originalRecord.channels);
-    if (result < 0)
-      return false;
-
-    fixedData |= result > 0;
-  }
+    targetFormat.channels = originalRecord.channels;
 
   if (options.common.fixSampleRate)
-  {
-    const auto result = PCMS16ChangeSampleRate(fixedHeader, pcms16Decoded, originalRecord.sampleRate);
-    if (result < 0)
-      return false;
+    targetFormat.sampleRate = originalRecord.sampleRate;
 
-    fixedData |= result > 0;
-  }
-
-  if (!options.common.transcodeToOriginalFormat || originalRecord.format == AudioDataFormat::PCM_S16)
+  if (options.common.transcodeToOriginalFormat && originalRecord.format != AudioDataFormat::PCM_S16)
   {
-    archiveRecord = PCMS16SoundRecord(fixedHeader, pcms16Decoded);
-    archiveRecord.samplesPerBlock = 1;
+    const auto fixedData = targetFormat.channels != soundRecord.channels || targetFormat.sampleRate != soundRecord.sampleRate;
+    if (!fixedData && soundRecord.format == originalRecord.format)
+      return ImportNative(soundRecord, soundDataView, {}, options);
 
-    data.resize(archiveRecord.dataSize);
-    std::memcpy(data.data(), pcms16Decoded.data(), archiveRecord.dataSize);
-
-    return true;
-  }
-
-  if (fixedData || soundRecord.format != originalRecord.format)
-  {
     switch (originalRecord.format)
     {
       case AudioDataFormat::IMA_ADPCM: {
-        std::vector<char> adpcmData(archiveRecord.dataSize);
-        if (!PCMS16ToADPCM(fixedHeader, pcms16Decoded, adpcmData, AudioConversionFlag::RAWOutput))
-          return false;
-
-        archiveRecord = ADPCMSoundRecord(ADPCMHeader(PCMS16SoundRecord(fixedHeader)), adpcmData);
-
-        data.resize(archiveRecord.dataSize);
-        std::memcpy(data.data(), adpcmData.data(), archiveRecord.dataSize);
-
-        return true;
+        targetFormat.format = AudioDataFormat::IMA_ADPCM;
+        if (originalRecord.channels != 0)
+          targetFormat.blockAlign = static_cast<uint16_t>(originalRecord.blockAlign / originalRecord.channels * targetFormat.channels);
+        break;
       }
       case AudioDataFormat::OGG_VORBIS: {
-        std::vector<char> vorbisData;
-        if (!PCMS16ToVorbis(fixedHeader, pcms16Decoded, vorbisData))
-          return false;
-
-        archiveRecord = VorbisSoundRecord(VorbisHeader(vorbisData), vorbisData);
-
-        data.resize(archiveRecord.dataSize);
-        std::memcpy(data.data(), vorbisData.data(), archiveRecord.dataSize);
-
-        return true;
+        targetFormat.format = AudioDataFormat::OGG_VORBIS;
+        break;
       }
       default: {
         // Never should get here!
@@ -97,7 +117,16 @@ bool Glacier1AudioFile::Import(AudioDataInfo soundRecord, const std::span<const
     }
   }
 
-  return ImportNative(soundRecord, soundDataView, {}, options);
+  // NOTE - source was already transcoded or queued for the same target, repeated imports are free until it changes
+  if (importSourceXXH3 == soundRecord.dataXXH3 && importTargetFormat == targetFormat)
+    return true;
+
+  // NOTE - transcode itself is deferred, all pending imports are transcoded in one batch before save or export
+  pendingImport = std::make_shared<Glacier1PendingImport>(Glacier1PendingImport{Glacier1ImportSource::Get(soundRecord, soundDataView), targetFormat});
+  importSourceXXH3 = soundRecord.dataXXH3;
+  importTargetFormat = targetFormat;
+
+  return true;
 }
 
 bool Glacier1AudioFile::Import(const std::span<const char> &in, const Options &options)
@@ -111,8 +140,8 @@ bool Glacier1AudioFile::Import(const std::span<const char> &in, const Options &o
 
 bool Glacier1AudioFile::Import(const StringView8CI &importPath, const Options& options)
 {
-  auto importData = ReadWholeBinaryFile(importPath);
-  if (importData.empty())
+  auto &importData = TranscodeScratch::Get().input;
+  if (!ReadWholeBinaryFile(importPath, importData))
     return false;
 
   return Import(importData, options);
@@ -123,6 +152,9 @@ bool Glacier1AudioFile::ImportNative(const AudioDataInfo &soundRecord, const std
   if (!soundRecord.dataSize || soundDataView.size() < soundRecord.dataSize)
     return false;
 
+  pendingImport.reset();
+  importSourceXXH3 = 0;
+
   if (!options.common.importSameFiles && (archiveRecord.dataXXH3 == soundRecord.dataXXH3))
     return true;
 
@@ -136,8 +168,7 @@ bool Glacier1AudioFile::ImportNative(const AudioDataInfo &soundRecord, const std
       if (archiveRecord.format != AudioDataFormat::IMA_ADPCM)
         archiveRecord.samplesPerBlock = 1;
 
-      data.resize(archiveRecord.dataSize);
-      std::memcpy(data.data(), soundDataView.data(), archiveRecord.dataSize);
+      data.assign(soundDataView.data(), soundDataView.data() + archiveRecord.dataSize);
 
       return true;
     }
@@ -148,9 +179,8 @@ bool Glacier1AudioFile::ImportNative(const AudioDataInfo &soundRecord, const std
       archiveRecord = PCMS16SoundRecord(PCMS16Header(soundRecord), soundRecord.dataXXH3);
       archiveRecord.samplesPerBlock = 1;
 
-      const auto newDataSize = pcms16DataView.size() * sizeof(int16_t);
-      data.resize(newDataSize);
-      std::memcpy(data.data(), pcms16DataView.data(), newDataSize);
+      const auto *pcms16Bytes = reinterpret_cast<const char *>(pcms16DataView.data());
+      data.assign(pcms16Bytes, pcms16Bytes + pcms16DataView.size() * sizeof(int16_t));
 
       return true;
     }
@@ -171,16 +201,22 @@ bool Glacier1AudioFile::ImportNative(AudioDataInfo soundRecord, const std::span<
     return ImportNative(soundRecord, soundDataView, std::span<const int16_t>{}, options);
   }
 
-  std::vector<int16_t> pcms16Decoded;
+  // NOTE - only data in unknown formats is stored decoded, everything else needs just the hash
+  if (!allowConversions || soundRecord.format != AudioDataFormat::UNKNOWN_SUPPORTED)
+  {
+    soundRecord.dataXXH3 = PCMS16SoundDataXXH3(soundRecord, soundDataView);
+    if (soundRecord.dataXXH3 == 0)
+      return false;
+
+    return ImportNative(soundRecord, soundDataView, std::span<const int16_t>{}, options);
+  }
+
+  auto &pcms16Decoded = TranscodeScratch::Get().pcms16;
   if (!PCMS16FromSoundData(soundRecord, soundDataView, pcms16Decoded, AudioConversionFlag::RAWOutput))
     return false;
 
   soundRecord.dataXXH3 = XXH3_64bits(pcms16Decoded.data(), pcms16Decoded.size() * sizeof(int16_t));
-  std::span<const int16_t> pcms16Span;
-  if (allowConversions)
-    pcms16Span = pcms16Decoded;
-
-  return ImportNative(soundRecord, soundDataView, pcms16Span, options);
+  return ImportNative(soundRecord, soundDataView, pcms16Decoded, options);
 }
 
 bool Glacier1AudioFile::ImportNative(const std::span<const char>& in, const bool allowConversions, const Options& options)
@@ -191,14 +227,50 @@ bool Glacier1AudioFile::ImportNative(const std::span<const char>& in, const bool
 
 bool Glacier1AudioFile::ImportNative(const StringView8CI &importPath, const bool allowConversions, const Options& options)
 {
-  auto importData = ReadWholeBinaryFile(importPath);
-  if (importData.empty())
+  auto &importData = TranscodeScratch::Get().input;
+  if (!ReadWholeBinaryFile(importPath, importData))
     return false;
 
   return ImportNative(importData, allowConversions, options);
 }
 
-bool Glacier1AudioFile::ExportNative(std::vector<char> &outputBytes, const Options&) const
+bool Glacier1AudioFile::ResolvePendingImport()
+{
+  if (!pendingImport)
+    return true;
+
+  const auto resolvedImport = std::move(pendingImport);
+
+  auto &transcodedData = TranscodeScratch::Get().encoded;
+  transcodedData.clear();
+
+  AudioDataInfo transcodedRecord;
+  const auto &importSource = *resolvedImport->source;
+  if (!TranscodeSoundData(importSource.soundRecord, importSource.soundData, resolvedImport->targetFormat, transcodedData, transcodedRecord))
+  {
+    importSourceXXH3 = 0;
+    return false;
+  }
+
+  archiveRecord = transcodedRecord;
+  data.assign(transcodedData.data(), transcodedData.data() + archiveRecord.dataSize);
+
+  return true;
+}
+
+bool Glacier1AudioFile::ExportNative(std::vector<char> &outputBytes, const Options& options) const
+{
+  if (!ExportNativeHeader(outputBytes, options))
+    return false;
+
+  const auto dataOffset = outputBytes.size();
+  outputBytes.resize(dataOffset + data.size(), 0);
+  std::memcpy(outputBytes.data() + dataOffset, data.data(), data.size());
+
+  return true;
+}
+
+bool Glacier1AudioFile::ExportNativeHeader(std::vector<char> &outputBytes, const Options&) const
 {
   const auto outIndexInput = outputBytes.size();
 
@@ -224,13 +296,23 @@ bool Glacier1AudioFile::ExportNative(std::vector<char> &outputBytes, const Optio
     return false;
   }
 
-  const auto dataOffset = outputBytes.size();
-  outputBytes.resize(dataOffset + data.size(), 0);
-  std::memcpy(outputBytes.data() + dataOffset, data.data(), data.size());
-
   return true;
 }
 
+bool Glacier1AudioFile::IsExportNative(const Options& options) const
+{
+  if (!options.common.transcodeToPlayableFormat)
+    return true;
+
+  if (archiveRecord.sampleRate != PlayableSampleRate(archiveRecord.sampleRate) || archiveRecord.blockAlign != archiveRecord.channels * (archiveRecord.bitsPerSample / 8))
+    return false;
+
+  if (archiveRecord.format == AudioDataFormat::PCM_S16)
+    return true;
+
+  return !options.common.transcodeOGGToPCM && archiveRecord.format == AudioDataFormat::OGG_VORBIS;
+}
+
 bool Glacier1AudioFile::Export(std::vector<char> &outputBytes, const Options& options) const
 {
   if (!options.common.transcodeToPlayableFormat)
@@ -252,47 +334,32 @@ bool Glacier1AudioFile::Export(std::vector<char> &outputBytes, const Options& op
     return false;
   }
 
-  OrderedSet<uint32_t> normalSampleRates{0, 11025, 22050, 44100, 48000};
-  auto normalSampleRateIt = ranges::lower_bound(normalSampleRates, archiveRecord.sampleRate);
-  if (normalSampleRateIt == normalSampleRates.end())
-  {
-    assert(false);
-    return false;
-  }
-  if (++normalSampleRateIt == normalSampleRates.end())
+  const auto normalSampleRate = PlayableSampleRate(archiveRecord.sampleRate);
+  if (normalSampleRate == 0)
   {
     assert(false);
     return false;
   }
 
-  const auto normalSampleRate = *normalSampleRateIt;
-  if (archiveRecord.sampleRate == normalSampleRate&& archiveRecord.blockAlign == archiveRecord.channels * (archiveRecord.bitsPerSample / 8))
-  {
-    if (archiveRecord.format == AudioDataFormat::PCM_S16)
-      return ExportNative(outputBytes, options);
+  if (IsExportNative(options))
+    return ExportNative(outputBytes, options);
 
-    if (!options.common.transcodeOGGToPCM && archiveRecord.format == AudioDataFormat::OGG_VORBIS)
-      return ExportNative(outputBytes, options);
-  }
+  const auto outIndexInput = outputBytes.size();
+  outputBytes.resize(outIndexInput + sizeof(PCMS16_Header));
 
-  auto pcms16Header = PCMS16Header(archiveRecord);
-  std::vector<int16_t> pcms16Decoded;
-  if (!PCMS16FromSoundData(archiveRecord, data, pcms16Decoded, AudioConversionFlag::RAWOutput))
-  {
-    assert(false);
-    return false;
-  }
+  TranscodeFormat targetFormat{AudioDataFormat::PCM_S16, normalSampleRate, archiveRecord.channels};
+  targetFormat.resamplerQuality = options.common.resamplerQuality;
 
-  if (PCMS16ChangeSampleRate(pcms16Header, pcms16Decoded, normalSampleRate) < 0)
+  AudioDataInfo transcodedRecord;
+  if (!TranscodeSoundData(archiveRecord, data, targetFormat, outputBytes, transcodedRecord))
   {
     assert(false);
+    outputBytes.resize(outIndexInput);
     return false;
   }
 
-  const auto outIndexInput = outputBytes.size();
-  outputBytes.resize(outIndexInput + sizeof(PCMS16_Header) + pcms16Decoded.size() * sizeof(int16_t));
+  const auto pcms16Header = PCMS16Header(transcodedRecord);
   std::memcpy(outputBytes.data() + outIndexInput, &pcms16Header, sizeof(PCMS16_Header));
-  std::memcpy(outputBytes.data() + outIndexInput + sizeof(PCMS16_Header), pcms16Decoded.data(), pcms16Decoded.size() * sizeof(int16_t));
 
   return true;
 }
@@ -322,6 +389,10 @@ bool Glacier1ArchiveDialog::IsImportAllowed() const
 
 bool Glacier1ArchiveDialog::GenerateOriginalData(const Options &options)
 {
+  // NOTE - records of all files are hashed into new original data, so data not loaded yet has to be loaded first
+  if (originalDataParentID == 0 && !LoadDeferredData(options))
+    return false;
+
   auto dataPathString = originalDataPathPrefix;
   dataPathString += Format("{:16X}", originalDataID);
   const auto dataPath = dataPathString.path();
@@ -411,10 +482,10 @@ bool Glacier1ArchiveDialog::LoadOriginalData(const Options &options)
     genFile.read(reinterpret_cast<char *>(&file.originalRecord), sizeof(Glacier1AudioRecord));
 
     assert(file.originalRecord.dataXXH3 != 0);
-    assert(file.archiveRecord.dataXXH3 != 0);
 
+    // NOTE - data which was not loaded yet is not hashed, it is still original
     auto &archiveFile = GetFile(filePath);
-    archiveFile.original = file.originalRecord == file.archiveRecord;
+    archiveFile.original = file.archiveRecord.dataXXH3 == 0 || file.originalRecord == file.archiveRecord;
   }
 
   std::ios_base::sync_with_stdio(oldSync);
@@ -440,7 +511,7 @@ bool Glacier1ArchiveDialog::ImportSingleHitmanFile(Glacier1AudioFile &glacier1Au
   if (glacier1AudioFile.originalRecord.dataXXH3 == 0)
     glacier1AudioFile.originalRecord = glacier1AudioFile.archiveRecord;
 
-  archiveFile.original = glacier1AudioFile.originalRecord == glacier1AudioFile.archiveRecord;
+  archiveFile.original = !glacier1AudioFile.pendingImport && glacier1AudioFile.originalRecord == glacier1AudioFile.archiveRecord;
   archiveFile.dirty = archiveFile.dirty || !archiveFile.original;
 
   return true;
@@ -448,7 +519,8 @@ bool Glacier1ArchiveDialog::ImportSingleHitmanFile(Glacier1AudioFile &glacier1Au
 
 bool Glacier1ArchiveDialog::ImportSingleHitmanFile(Glacier1AudioFile &glacier1AudioFile, const StringView8CI &importFilePath, const Options &options)
 {
-  auto inputData = ReadWholeBinaryFile(importFilePath);
+  auto &inputData = TranscodeScratch::Get().input;
+  ReadWholeBinaryFile(importFilePath, inputData);
   return ImportSingleHitmanFile(glacier1AudioFile, inputData, !options.common.directImport, options);
 }
 
@@ -462,15 +534,28 @@ bool Glacier1ArchiveDialog::ExportSingleHitmanFile(const Glacier1AudioFile &glac
 
 bool Glacier1ArchiveDialog::ExportSingleHitmanFile(const Glacier1AudioFile &glacier1AudioFile, const StringView8CI &exportFolderPath, const Options &options) const
 {
-  std::vector<char> outputData;
-  if (!ExportSingleHitmanFile(glacier1AudioFile, outputData, options.common.transcodeToPlayableFormat, options))
+  auto &outputData = TranscodeScratch::Get().encoded;
+  outputData.clear();
+
+  // NOTE - native data is written straight from the file, only its small header goes through the output buffer
+  std::span<const char> nativeData;
+  if (glacier1AudioFile.IsExportNative(options))
+  {
+    if (!glacier1AudioFile.ExportNativeHeader(outputData, options))
+      return false;
+
+    nativeData = glacier1AudioFile.data;
+  }
+  else if (!ExportSingleHitmanFile(glacier1AudioFile, outputData, true, options))
     return false;
 
-  if (outputData.size() < 4)
+  const auto magicData = outputData.empty() ? nativeData : std::span<const char>(outputData);
+  if (magicData.size() < 4)
     return false;
 
   auto exportPath = exportFolderPath.path() / glacier1AudioFile.path.path();
-  const auto magic = *reinterpret_cast<const uint32_t*>(outputData.data());
+  uint32_t magic = 0;
+  std::memcpy(&magic, magicData.data(), sizeof(magic));
   switch (magic)
   {
     case 'FFIR': {
@@ -492,6 +577,7 @@ bool Glacier1ArchiveDialog::ExportSingleHitmanFile(const Glacier1AudioFile &glac
 
   std::ofstream exportBin(exportPath, std::ios::binary | std::ios::trunc);
   exportBin.write(outputData.data(), static_cast<int64_t>(outputData.size()));
+  exportBin.write(nativeData.data(), static_cast<int64_t>(nativeData.size()));
 
   std::ios_base::sync_with_stdio(oldSync);
 
@@ -507,6 +593,90 @@ bool Glacier1ArchiveDialog::ExportSingle(const StringView8CI &exportFolderPath,
   return ExportSingleHitmanFile(fileMapIt->second, exportFolderPath, options);
 }
 
+bool Glacier1ArchiveDialog::ResolvePendingImports(const Options &)
+{
+  std::vector<Glacier1AudioFile *> pendingFiles;
+  for (auto &glacier1AudioFile : fileMap | ranges::views::values)
+  {
+    if (glacier1AudioFile.pendingImport)
+      pendingFiles.emplace_back(&glacier1AudioFile);
+  }
+
+  if (pendingFiles.empty())
+    return true;
+
+  // NOTE - same clip is often imported for several entries, each distinct source and target format is transcoded once
+  OrderedMap<std::pair<uint64_t, TranscodeFormat>, std::vector<Glacier1AudioFile *>> pendingTranscodesMap;
+  for (auto *glacier1AudioFile : pendingFiles)
+  {
+    const auto &pendingImport = *glacier1AudioFile->pendingImport;
+    pendingTranscodesMap[{pendingImport.source->soundRecord.dataXXH3, pendingImport.targetFormat}].emplace_back(glacier1AudioFile);
+  }
+
+  std::vector<std::vector<Glacier1AudioFile *> *> pendingTranscodes;
+  pendingTranscodes.reserve(pendingTranscodesMap.size());
+  for (auto &transcodeFiles : pendingTranscodesMap | ranges::views::values)
+    pendingTranscodes.emplace_back(&transcodeFiles);
+
+  progressNextTotal = pendingTranscodes.size();
+  progressNext = 0;
+
+  // NOTE - largest sources are transcoded first, so long encodes do not end up as the tail of the whole batch
+  ranges::stable_sort(pendingTranscodes, std::greater{}, [](const auto *transcodeFiles) { return transcodeFiles->front()->pendingImport->source->soundData.size(); });
+
+  std::atomic_bool resolveFailed = false;
+  std::atomic_size_t nextPendingTranscode = 0;
+  std::vector<size_t> resolveWorkers(std::max(std::thread::hardware_concurrency(), 1u));
+  std::for_each(std::execution::par, resolveWorkers.begin(), resolveWorkers.end(), [this, &pendingTranscodes, &nextPendingTranscode, &resolveFailed](auto&)
+  {
+    for (auto pendingTranscode = nextPendingTranscode++; pendingTranscode < pendingTranscodes.size(); pendingTranscode = nextPendingTranscode++)
+    {
+      const auto &transcodeFiles = *pendingTranscodes[pendingTranscode];
+      auto &resolvedFile = *transcodeFiles.front();
+
+      {
+        std::unique_lock progressMessageLock(progressMessageMutex);
+        progressMessage = g_LocalizationManager.LocalizeFormat("ARCHIVE_DIALOG_IMPORT_PROGRESS_TRANSCODING_FILE", resolvedFile.path);
+        ++progressNext;
+      }
+
+      const auto resolved = resolvedFile.ResolvePendingImport();
+      if (!resolved)
+        resolveFailed = true;
+
+      for (auto *glacier1AudioFile : transcodeFiles | ranges::views::drop(1))
+      {
+        glacier1AudioFile->pendingImport.reset();
+        if (!resolved)
+        {
+          glacier1AudioFile->importSourceXXH3 = 0;
+          continue;
+        }
+
+        // NOTE - every file owns its data, archive writers and Glacier1SharedAudioData patch and compare data of single
+        //        file, so only the encode is shared, copy reuses capacity left in the file by previous data
+        glacier1AudioFile->archiveRecord = resolvedFile.archiveRecord;
+        glacier1AudioFile->data.assign(resolvedFile.data.begin(), resolvedFile.data.end());
+      }
+    }
+  });
+
+  for (const auto *glacier1AudioFile : pendingFiles)
+  {
+    UpdateArchiveRecords(*glacier1AudioFile);
+
+    auto &archiveFile = GetFile(glacier1AudioFile->path);
+    archiveFile.original = glacier1AudioFile->originalRecord == glacier1AudioFile->archiveRecord;
+    archiveFile.dirty = archiveFile.dirty || !archiveFile.original;
+  }
+
+  return !resolveFailed;
+}
+
+void Glacier1ArchiveDialog::UpdateArchiveRecords(const Glacier1AudioFile &)
+{
+}
+
 int32_t Glacier1ArchiveDialog::ReloadOriginalData(const bool reset, const Options &options)
 {
   needsOriginalDataReload = true;
@@ -7,9 +7,26 @@
 #pragma once
 
 #include "ArchiveDialog.hpp"
+#include "Transcode.hpp"
 
 using Glacier1AudioRecord = AudioDataInfo;
 
+// Source data of transcoding imports. Imports of same decoded data share single copy of it until all of them are resolved.
+struct Glacier1ImportSource
+{
+  static std::shared_ptr<const Glacier1ImportSource> Get(const AudioDataInfo &soundRecord, const std::span<const char> &soundDataView);
+
+  AudioDataInfo soundRecord;
+  std::vector<char> soundData;
+};
+
+// Transcode requested by import, performed later together with all other pending imports.
+struct Glacier1PendingImport
+{
+  std::shared_ptr<const Glacier1ImportSource> source;
+  TranscodeFormat targetFormat;
+};
+
 struct Glacier1AudioFile
 {
   bool Import(AudioDataInfo soundRecord, const std::span<const char>& soundDataView, const Options& options);
@@ -24,11 +41,30 @@ struct Glacier1AudioFile
   bool Export(std::vector<char> &outputBytes, const Options& options) const;
 
   bool ExportNative(std::vector<char> &outputBytes, const Options& options) const;
+  // Appends only the header of native export, data follows it unchanged. Nothing is appended for OGG Vorbis.
+  bool ExportNativeHeader(std::vector<char> &outputBytes, const Options& options) const;
+  // Whether Export writes the data unchanged, same as ExportNative.
+  bool IsExportNative(const Options& options) const;
+
+  bool ResolvePendingImport();
 
   StringView8CI path;
   Glacier1AudioRecord archiveRecord;
   Glacier1AudioRecord originalRecord;
   std::vector<char> data;
+  std::shared_ptr<Glacier1PendingImport> pendingImport;
+  // Source and target of the last transcoding import, importing same source again for same target does nothing.
+  uint64_t importSourceXXH3 = 0;
+  TranscodeFormat importTargetFormat;
+};
+
+// File whose data is stored in archive only once, together with data of another file. It is saved separately once their data differ.
+struct Glacier1SharedAudioData
+{
+  StringView8CI path;
+  std::vector<char> &data;
+  const Glacier1AudioRecord &archiveRecord;
+  uint32_t newOffset = 0;
 };
 
 class Glacier1ArchiveDialog : public ArchiveDialog
@@ -52,8 +88,33 @@ public:
 
   bool ExportSingle(const StringView8CI &exportFolderPath, const StringView8CI &exportFilePath, const Options &options) const override;
 
+  bool ResolvePendingImports(const Options &options) override;
+  // Propagates record of the file into archive specific records.
+  virtual void UpdateArchiveRecords(const Glacier1AudioFile &glacier1AudioFile);
+
   int32_t DrawGlacier1ArchiveDialog();
 
+  // Runs save jobs concurrently, in order they are given. Only few of them run at once, as they are bound by disk rather than CPU.
+  template <typename SaveJob>
+  static bool RunSaveJobs(const size_t jobsCount, const SaveJob &saveJob)
+  {
+    std::atomic_bool saveFailed = false;
+    std::atomic_size_t nextSaveJob = 0;
+    std::vector<size_t> saveWorkers(std::min<size_t>({std::max(std::thread::hardware_concurrency(), 1u), maxConcurrentSaveJobs, std::max<size_t>(jobsCount, 1)}));
+    std::for_each(std::execution::par, saveWorkers.begin(), saveWorkers.end(), [jobsCount, &saveJob, &saveFailed, &nextSaveJob](auto&)
+    {
+      for (auto saveJobIndex = nextSaveJob++; saveJobIndex < jobsCount; saveJobIndex = nextSaveJob++)
+      {
+        if (!saveJob(saveJobIndex))
+          saveFailed.store(true, std::memory_order_relaxed);
+      }
+    });
+
+    return !saveFailed;
+  }
+
+  static constexpr size_t maxConcurrentSaveJobs = 4;
+
   OrderedMap<StringView8CI, Glacier1AudioFile> fileMap;
   String8CI originalDataPathPrefix;
   uint64_t originalDataID = 0;
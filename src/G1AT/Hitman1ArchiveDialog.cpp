@@ -10,6 +10,87 @@
 
 #include "Utils.hpp"
 
+namespace
+{
+
+constexpr size_t hitman1SaveChunkRecords = 64;
+
+bool IsIndexWhitespace(const char character)
+{
+  return character == ' ' || character == '\t' || character == '\r' || character == '\n';
+}
+
+// Takes next token from the line, tokens are separated by spaces or tabs.
+std::string_view TakeIndexToken(std::string_view &line)
+{
+  while (!line.empty() && IsIndexWhitespace(line.front()))
+    line.remove_prefix(1);
+
+  size_t tokenSize = 0;
+  while (tokenSize < line.size() && !IsIndexWhitespace(line[tokenSize]))
+    ++tokenSize;
+
+  const auto token = line.substr(0, tokenSize);
+  line.remove_prefix(tokenSize);
+  return token;
+}
+
+template <typename Integer>
+bool ParseIndexInteger(const std::string_view token, Integer &value)
+{
+  const auto [tokenEnd, errorCode] = std::from_chars(token.data(), token.data() + token.size(), value);
+  return !token.empty() && errorCode == std::errc{} && tokenEnd == token.data() + token.size();
+}
+
+}
+
+std::string_view Hitman1LastModifiedDate::GetMonth() const
+{
+  return {month.data(), month.size()};
+}
+
+std::string_view Hitman1LastModifiedDate::GetTime() const
+{
+  return {time.data(), timeLength};
+}
+
+bool ParseHitman1IndexEntry(std::string_view &text, Hitman1IndexEntry &entry)
+{
+  while (!text.empty() && IsIndexWhitespace(text.front()))
+    text.remove_prefix(1);
+
+  const auto lineSize = std::min(text.find('\n'), text.size());
+  auto line = text.substr(0, lineSize);
+
+  if (TakeIndexToken(line) != "-rw-rw-r--" || TakeIndexToken(line) != "1" || TakeIndexToken(line) != "zope")
+    return false;
+
+  if (!ParseIndexInteger(TakeIndexToken(line), entry.dataSize))
+    return false;
+
+  const auto month = TakeIndexToken(line);
+  if (month.size() != entry.lastModifiedDate.month.size())
+    return false;
+
+  if (!ParseIndexInteger(TakeIndexToken(line), entry.lastModifiedDate.day))
+    return false;
+
+  const auto time = TakeIndexToken(line);
+  if (time.empty() || time.size() > entry.lastModifiedDate.time.size())
+    return false;
+
+  entry.path = TakeIndexToken(line);
+  if (entry.path.empty())
+    return false;
+
+  std::memcpy(entry.lastModifiedDate.month.data(), month.data(), month.size());
+  std::memcpy(entry.lastModifiedDate.time.data(), time.data(), time.size());
+  entry.lastModifiedDate.timeLength = static_cast<uint8_t>(time.size());
+
+  text.remove_prefix(lineSize);
+  return true;
+}
+
 bool Hitman1ArchiveDialog::Clear(const bool retVal)
 {
   indexToKey.clear();
@@ -34,8 +115,8 @@ bool Hitman1ArchiveDialog::LoadImpl(const StringView8CI &loadPathView, const Opt
   const auto oldSync = std::ios_base::sync_with_stdio(false);
 
   const auto archiveBin = ReadWholeBinaryFile(String8(archiveBinFilePath));
-  auto archiveIdx = ReadWholeTextFile(loadPathView).native();
-  auto archiveIdxScan = scn::make_result(archiveIdx);
+  const auto archiveIdx = ReadWholeTextFile(loadPathView).native();
+  std::string_view archiveIdxText = archiveIdx;
   size_t archiveBinOffset = 0;
 
   struct Hitman1Record
@@ -45,37 +126,33 @@ bool Hitman1ArchiveDialog::LoadImpl(const StringView8CI &loadPathView, const Opt
   };
 
   std::vector<Hitman1Record> records;
-  while (archiveIdxScan && archiveBinOffset < archiveBin.size())
+  Hitman1IndexEntry indexEntry;
+  while (archiveBinOffset < archiveBin.size())
   {
-    std::string_view entryPath;
-    std::string_view month;
-    auto day = 0ull;
-    std::string_view time;
-    auto dataSize = 0ull;
-    archiveIdxScan = scn::scan(archiveIdxScan.range(), "-rw-rw-r--   1 zope {} {} {} {} {}", dataSize, month, day, time, entryPath);
-    archiveIdxScan = scn::ignore_until(archiveIdxScan.range(), '-');
-
-    if (!archiveIdxScan)
+    if (!ParseHitman1IndexEntry(archiveIdxText, indexEntry))
     {
-      if (archiveIdxScan.error() == scn::error::code::end_of_range)
+      if (archiveIdxText.empty())
         break;
 
       return Clear(false);
     }
 
-    auto& file = GetFile(entryPath);
+    if (indexEntry.dataSize > archiveBin.size() - archiveBinOffset)
+      return Clear(false);
+
+    auto& file = GetFile(indexEntry.path);
 
     auto [fileMapIt, inserted] = fileMap.try_emplace(file.path, Glacier1AudioFile{file.path});
     if (!inserted)
       return Clear(false);
 
-    if (!lastModifiedDatesMap.try_emplace(file.path, Format("{} {:2d} {}", month, day, time)).second)
+    if (!lastModifiedDatesMap.try_emplace(file.path, indexEntry.lastModifiedDate).second)
       return Clear(false);
 
     indexToKey.emplace_back(file.path);
-    records.emplace_back(fileMapIt->second, std::span<const char>{archiveBin.data() + archiveBinOffset, dataSize});
+    records.emplace_back(fileMapIt->second, std::span<const char>{archiveBin.data() + archiveBinOffset, indexEntry.dataSize});
 
-    archiveBinOffset += dataSize;
+    archiveBinOffset += indexEntry.dataSize;
   }
 
   if (archiveBinOffset < archiveBin.size())
@@ -140,36 +217,115 @@ bool Hitman1ArchiveDialog::SaveImpl(const StringView8CI &savePathView, const Opt
   auto archiveBinFilePath = archiveIdxFilePath;
   archiveBinFilePath.replace_extension(L".bin");
 
-  const auto oldSync = std::ios_base::sync_with_stdio(false);
-
-  std::ofstream archiveIdx(archiveIdxFilePath, std::ios::trunc);
-  std::ofstream archiveBin(archiveBinFilePath, std::ios::binary | std::ios::trunc);
+  struct Hitman1SaveRecord
+  {
+    StringView8CI path;
+    const Glacier1AudioFile *file = nullptr;
+    const Hitman1LastModifiedDate *lastModifiedDate = nullptr;
+    std::vector<char> header;
+    uint64_t offset = 0;
+  };
 
-  std::vector<char> exportBytes;
-  for (const auto &filePath : indexToKey)
+  std::vector<Hitman1SaveRecord> saveRecords(indexToKey.size());
+  for (size_t i = 0; i < indexToKey.size(); ++i)
   {
-    auto fileIt = fileMap.find(filePath);
+    auto fileIt = fileMap.find(indexToKey[i]);
     if (fileIt == fileMap.end())
       return false;
 
-    auto lastModifiedDateIt = lastModifiedDatesMap.find(filePath);
+    auto lastModifiedDateIt = lastModifiedDatesMap.find(indexToKey[i]);
     if (lastModifiedDateIt == lastModifiedDatesMap.end())
       return false;
 
-    fileIt->second.ExportNative(exportBytes, options);
+    saveRecords[i].path = indexToKey[i];
+    saveRecords[i].file = &fileIt->second;
+    saveRecords[i].lastModifiedDate = &lastModifiedDateIt->second;
+  }
+
+  // NOTE - data follows headers unchanged, so offset of every entry is known before anything is written
+  std::atomic_bool saveFailed = false;
+  std::for_each(std::execution::par, saveRecords.begin(), saveRecords.end(), [&saveFailed, &options](auto &saveRecord)
+  {
+    if (!saveRecord.file->ExportNativeHeader(saveRecord.header, options))
+      saveFailed.store(true, std::memory_order_relaxed);
+  });
 
-    archiveIdx << Format("-rw-rw-r--   1 zope {:12d} {} {}\n", exportBytes.size(), lastModifiedDateIt->second,
-                              filePath).native();
-    archiveBin.write(exportBytes.data(), static_cast<int64_t>(exportBytes.size()));
+  if (saveFailed)
+    return false;
 
-    GetFile(filePath).dirty = false;
+  std::string archiveIdxText;
+  uint64_t archiveBinSize = 0;
+  for (auto &saveRecord : saveRecords)
+  {
+    const auto &lastModifiedDate = *saveRecord.lastModifiedDate;
+    const auto entrySize = saveRecord.header.size() + saveRecord.file->data.size();
+    archiveIdxText += Format("-rw-rw-r--   1 zope {:12d} {} {:2d} {} {}\n", entrySize, lastModifiedDate.GetMonth(), lastModifiedDate.day,
+                             lastModifiedDate.GetTime(), saveRecord.path).native();
+
+    saveRecord.offset = archiveBinSize;
+    archiveBinSize += entrySize;
+  }
+
+  const auto oldSync = std::ios_base::sync_with_stdio(false);
+
+  std::ofstream(archiveBinFilePath, std::ios::binary | std::ios::trunc).close();
+
+  std::error_code errorCode;
+  resize_file(archiveBinFilePath, archiveBinSize, errorCode);
+  if (errorCode)
+  {
+    std::ios_base::sync_with_stdio(oldSync);
+    return false;
   }
 
-  archiveBin.close();
+  // NOTE - workers pull chunks of consecutive entries, each chunk is written through worker's own stream after single seek
+  std::atomic_size_t nextSaveChunk = 0;
+  std::vector<size_t> saveWorkers(std::max(std::thread::hardware_concurrency(), 1u));
+  std::for_each(std::execution::par, saveWorkers.begin(), saveWorkers.end(), [&archiveBinFilePath, &saveRecords, &saveFailed, &nextSaveChunk](auto&)
+  {
+    std::ofstream archiveBin;
+    for (auto saveChunk = nextSaveChunk++; saveChunk * hitman1SaveChunkRecords < saveRecords.size(); saveChunk = nextSaveChunk++)
+    {
+      if (!archiveBin.is_open())
+        archiveBin.open(archiveBinFilePath, std::ios::binary | std::ios::in | std::ios::out);
+
+      if (!archiveBin)
+        break;
+
+      const auto saveChunkBegin = saveChunk * hitman1SaveChunkRecords;
+      const auto saveChunkEnd = std::min(saveChunkBegin + hitman1SaveChunkRecords, saveRecords.size());
+      archiveBin.seekp(static_cast<int64_t>(saveRecords[saveChunkBegin].offset));
+      for (auto i = saveChunkBegin; i < saveChunkEnd; ++i)
+      {
+        const auto &saveRecord = saveRecords[i];
+        archiveBin.write(saveRecord.header.data(), static_cast<int64_t>(saveRecord.header.size()));
+        archiveBin.write(saveRecord.file->data.data(), static_cast<int64_t>(saveRecord.file->data.size()));
+      }
+    }
+
+    // NOTE - worker which got no chunk never opens its stream, failed open or write leaves it in failed state
+    if (archiveBin.is_open())
+      archiveBin.close();
+
+    if (!archiveBin)
+      saveFailed.store(true, std::memory_order_relaxed);
+  });
+
+  std::ofstream archiveIdx(archiveIdxFilePath, std::ios::trunc);
+  archiveIdx.write(archiveIdxText.data(), static_cast<int64_t>(archiveIdxText.size()));
   archiveIdx.close();
 
+  if (!archiveIdx)
+    saveFailed.store(true, std::memory_order_relaxed);
+
   std::ios_base::sync_with_stdio(oldSync);
 
+  if (saveFailed)
+    return false;
+
+  for (const auto &filePath : indexToKey)
+    GetFile(filePath).dirty = false;
+
   originalDataParentID = originalDataID;
 
   const auto archiveBinData = ReadWholeBinaryFile(String8CI(archiveBinFilePath));
@@ -8,6 +8,29 @@
 
 #include "Glacier1ArchiveDialog.hpp"
 
+// Last modification date as listed by `ls -l`, time is either time of the day or the year.
+struct Hitman1LastModifiedDate
+{
+  std::string_view GetMonth() const;
+  std::string_view GetTime() const;
+
+  std::array<char, 3> month{};
+  uint8_t day = 0;
+  uint8_t timeLength = 0;
+  std::array<char, 5> time{};
+};
+
+struct Hitman1IndexEntry
+{
+  std::string_view path; // points into parsed text
+  uint64_t dataSize = 0;
+  Hitman1LastModifiedDate lastModifiedDate;
+};
+
+// Parses next line of the index, advancing text past it. Whitespace before the line is skipped, so text is empty once
+// there are no more entries. Text is left at the start of the line when it is malformed.
+bool ParseHitman1IndexEntry(std::string_view &text, Hitman1IndexEntry &entry);
+
 class Hitman1ArchiveDialog final : public Glacier1ArchiveDialog
 {
 public:
@@ -27,5 +50,5 @@ public:
 
   std::vector<StringView8CI> indexToKey;
 
-  OrderedMap<StringView8CI, String8> lastModifiedDatesMap;
+  OrderedMap<StringView8CI, Hitman1LastModifiedDate> lastModifiedDatesMap;
 };
@@ -8,6 +8,7 @@
 
 #include "Hitman23ArchiveDialog.hpp"
 
+#include "Transcode.hpp"
 #include "Utils.hpp"
 
 Glacier1AudioRecord Hitman23WHDRecord::ToHitmanSoundRecord() const
@@ -38,12 +39,25 @@ void Hitman23WHDRecord::FromHitmanSoundRecord(const Glacier1AudioRecord &soundRe
   samplesPerBlock = soundRecord.samplesPerBlock;
 }
 
+uint32_t Hitman23WAVRecord::GetNewOffset(const StringView8CI &filePath) const
+{
+  for (const auto &sharedFileData : sharedData)
+  {
+    if (sharedFileData.path == filePath)
+      return sharedFileData.newOffset;
+  }
+
+  return newOffset;
+}
+
 bool Hitman23WAVFile::Clear(const bool retVal)
 {
   header = nullptr;
   recordMap.clear();
   extraData.clear();
   path.clear();
+  dirty = true;
+  loaded = false;
 
   return retVal;
 }
@@ -58,32 +72,31 @@ bool Hitman23WAVFile::Load(const std::vector<char> &wavData, const OrderedMap<St
   {
     uint32_t size = 0;
     Glacier1AudioFile& file;
+    std::vector<Glacier1AudioFile *> sharedFiles;
   };
 
-  auto resampledOffset = static_cast<uint32_t>(wavData.size());
-  size_t foundItems = 0;
-  OrderedMap<uint32_t, uint32_t> resampledMap;
+  // NOTE - records of different files may point to same data, it stays stored only once
+  std::vector<Glacier1AudioFile *> loadedFiles;
   OrderedMap<uint32_t, WAVFileData> offsetToWAVFileDataMap;
   for (auto& [whdRecordPath, whdRecord] : whdRecordsMap)
   {
     if ((whdRecord->dataInStreams == 0) != isMissionWAV)
       continue;
 
-    auto offsetToWAVFileDataIt = offsetToWAVFileDataMap.find(whdRecord->dataOffset);
-    if (offsetToWAVFileDataIt != offsetToWAVFileDataMap.end())
-    {
-      resampledMap[resampledOffset] = whdRecord->dataOffset;
-      whdRecord->dataOffset = resampledOffset;
-      resampledOffset += whdRecord->dataSize;
-    }
+    auto& file = fileMap.at(whdRecordPath);
+    if (whdRecord->dataOffset + static_cast<uint64_t>(whdRecord->dataSize) > wavData.size())
+      return Clear(false);
 
-    offsetToWAVFileDataMap.insert({whdRecord->dataOffset, {whdRecord->dataSize, fileMap.at(whdRecordPath)}});
+    const auto [offsetToWAVFileDataIt, offsetToWAVFileDataEmplaced] = offsetToWAVFileDataMap.try_emplace(whdRecord->dataOffset, WAVFileData{whdRecord->dataSize, file});
+    if (!offsetToWAVFileDataEmplaced)
+      offsetToWAVFileDataIt->second.sharedFiles.emplace_back(&file);
 
-    ++foundItems;
-  }
+    file.data.resize(whdRecord->dataSize, 0);
+    file.data.shrink_to_fit();
+    std::memcpy(file.data.data(), wavData.data() + whdRecord->dataOffset, whdRecord->dataSize);
 
-  if (offsetToWAVFileDataMap.size() != foundItems)
-    return Clear(false);
+    loadedFiles.emplace_back(&file);
+  }
 
   recordMap.clear();
 
@@ -100,6 +113,7 @@ bool Hitman23WAVFile::Load(const std::vector<char> &wavData, const OrderedMap<St
     else
       header = nullptr;
 
+    loaded = true;
     return true;
   }
 
@@ -116,14 +130,11 @@ bool Hitman23WAVFile::Load(const std::vector<char> &wavData, const OrderedMap<St
       recordMap.try_emplace(currOffset, Hitman23WAVRecord{newData, currOffset});
     }
 
-    auto& newData = wavFileData.file.data;
-    newData.resize(wavFileData.size, 0);
-    newData.shrink_to_fit();
+    auto& record = recordMap.try_emplace(offset, Hitman23WAVRecord{wavFileData.file.data, offset, &wavFileData.file.archiveRecord}).first->second;
+    for (auto *sharedFile : wavFileData.sharedFiles)
+      record.sharedData.emplace_back(Glacier1SharedAudioData{sharedFile->path, sharedFile->data, sharedFile->archiveRecord});
 
-    const auto trueOffset = offset >= wavData.size() ? resampledMap[offset] : offset;
-    std::memcpy(newData.data(), wavData.data() + trueOffset, wavFileData.size);
-    recordMap.try_emplace(offset, Hitman23WAVRecord{newData, offset});
-    currOffset = offset + wavFileData.size;
+    currOffset = std::max(currOffset, offset + wavFileData.size);
   }
 
   if (currOffset < wavData.size())
@@ -136,27 +147,32 @@ bool Hitman23WAVFile::Load(const std::vector<char> &wavData, const OrderedMap<St
     recordMap.try_emplace(currOffset, Hitman23WAVRecord{newData, currOffset});
   }
 
-  const auto wavFileDataView = offsetToWAVFileDataMap | ranges::views::values;
-
   std::atomic_bool importFailed = false;
-  std::for_each(std::execution::par, wavFileDataView.begin(), wavFileDataView.end(), [this, &importFailed](auto& wavFileData)
+  std::for_each(std::execution::par, loadedFiles.begin(), loadedFiles.end(), [this, &importFailed](auto* loadedFile)
   {
     if (importFailed.load(std::memory_order_relaxed))
       return;
 
-    auto& glacier1AudioFile = wavFileData.file;
-    glacier1AudioFile.archiveRecord = SoundDataSoundRecord(glacier1AudioFile.archiveRecord, glacier1AudioFile.data);
+    auto& glacier1AudioFile = *loadedFile;
+    glacier1AudioFile.archiveRecord = HashedSoundRecord(glacier1AudioFile.archiveRecord, glacier1AudioFile.data);
     importFailed.store(importFailed.load(std::memory_order_relaxed) || glacier1AudioFile.archiveRecord.dataXXH3 == 0);
   });
 
   if (importFailed)
     return Clear(false);
 
+  for (auto &record : recordMap | ranges::views::values)
+  {
+    if (record.archiveRecord != nullptr)
+      record.savedDataXXH3 = record.archiveRecord->dataXXH3;
+  }
+
   if (isMissionWAV && !recordMap.empty())
     header = reinterpret_cast<Hitman23WAVHeader *>(recordMap.at(0).data.data());
   else
     header = nullptr;
 
+  loaded = true;
   return true;
 }
 
@@ -170,46 +186,132 @@ bool Hitman23WAVFile::Load(const StringView8CI &loadPath, const OrderedMap<Strin
   return true;
 }
 
-bool Hitman23WAVFile::Save(const StringView8CI &savePathView)
+void Hitman23WAVFile::Layout()
 {
-  const auto savePath = savePathView.path();
-  create_directories(savePath.parent_path());
-
-  const auto oldSync = std::ios_base::sync_with_stdio(false);
-
-  std::ofstream wavData(savePath, std::ios::binary | std::ios::trunc);
+  dirty = false;
 
   uint32_t offset = 0;
-  for (auto &record : recordMap | ranges::views::values)
+  for (auto &[oldOffset, record] : recordMap)
   {
     record.newOffset = offset;
     offset += static_cast<uint32_t>(record.data.size());
+
+    dirty = dirty || record.newOffset != oldOffset || (record.archiveRecord != nullptr && record.archiveRecord->dataXXH3 != record.savedDataXXH3);
+
+    // NOTE - shared data is saved separately only once it differs from data of the owner
+    for (auto &sharedFileData : record.sharedData)
+    {
+      sharedFileData.newOffset = record.newOffset;
+      if (record.archiveRecord == nullptr || sharedFileData.archiveRecord.dataXXH3 == record.archiveRecord->dataXXH3)
+        continue;
+
+      sharedFileData.newOffset = offset;
+      offset += static_cast<uint32_t>(sharedFileData.data.size());
+
+      dirty = true;
+    }
   }
 
   if (header != nullptr)
+  {
+    dirty = dirty || header->fileSizeWithHeader != offset;
     header->fileSizeWithHeader = offset;
+  }
+}
+
+bool Hitman23WAVFile::Write(const StringView8CI &savePathView)
+{
+  // NOTE - scenes which were not touched are not written again
+  if (!dirty && CopyUnchangedFile(path, savePathView))
+  {
+    path = savePathView;
+    return true;
+  }
+
+  if (!loaded)
+    return false;
+
+  const auto savePath = savePathView.path();
+  create_directories(savePath.parent_path());
+
+  const auto oldSync = std::ios_base::sync_with_stdio(false);
+
+  std::ofstream wavData(savePath, std::ios::binary | std::ios::trunc);
+  if (!wavData)
+  {
+    std::ios_base::sync_with_stdio(oldSync);
+    return false;
+  }
 
   for (auto &record : recordMap | ranges::views::values)
+  {
     wavData.write(record.data.data(), record.data.size());
 
+    for (const auto &sharedFileData : record.sharedData)
+    {
+      if (sharedFileData.newOffset != record.newOffset)
+        wavData.write(sharedFileData.data.data(), sharedFileData.data.size());
+    }
+  }
+
+  wavData.close();
+
   std::ios_base::sync_with_stdio(oldSync);
 
+  if (!wavData)
+    return false;
+
   path = savePath;
 
   return true;
 }
 
+void Hitman23WAVFile::CommitLayout()
+{
+  OrderedMap<uint32_t, Hitman23WAVRecord> newRecordMap;
+  for (const auto &record : recordMap | ranges::views::values)
+  {
+    auto &newRecord = newRecordMap.try_emplace(record.newOffset, Hitman23WAVRecord{record.data, record.newOffset, record.archiveRecord}).first->second;
+    if (newRecord.archiveRecord != nullptr)
+      newRecord.savedDataXXH3 = newRecord.archiveRecord->dataXXH3;
+
+    // NOTE - shared data saved separately becomes record of its own
+    for (const auto &sharedFileData : record.sharedData)
+    {
+      if (sharedFileData.newOffset == record.newOffset)
+        newRecord.sharedData.emplace_back(sharedFileData);
+      else
+        newRecordMap.try_emplace(sharedFileData.newOffset, Hitman23WAVRecord{sharedFileData.data, sharedFileData.newOffset, &sharedFileData.archiveRecord, sharedFileData.archiveRecord.dataXXH3});
+    }
+  }
+
+  recordMap = std::move(newRecordMap);
+  dirty = false;
+}
+
+bool Hitman23WAVFile::Save(const StringView8CI &savePathView)
+{
+  Layout();
+  if (!Write(savePathView))
+    return false;
+
+  CommitLayout();
+  return true;
+}
+
 bool Hitman23WHDFile::Clear(const bool retVal)
 {
   header = nullptr;
   recordMap.clear();
+  parsedRecords.clear();
   data.clear();
+  dataXXH3 = 0;
   path.clear();
 
   return retVal;
 }
 
-bool Hitman23WHDFile::Load(Hitman23ArchiveDialog& archiveDialog, const StringView8CI &loadPathView)
+bool Hitman23WHDFile::Parse(const StringView8CI &loadPathView, const StringView8CI &basePathView)
 {
   if (data.empty())
     data = ReadWholeBinaryFile(loadPathView);
@@ -218,6 +320,7 @@ bool Hitman23WHDFile::Load(Hitman23ArchiveDialog& archiveDialog, const StringVie
     return Clear(false);
 
   recordMap.clear();
+  parsedRecords.clear();
 
   auto *whdPtr = data.data();
   header = reinterpret_cast<Hitman23WHDHeader *>(whdPtr);
@@ -243,10 +346,28 @@ bool Hitman23WHDFile::Load(Hitman23ArchiveDialog& archiveDialog, const StringVie
       return Clear(false);
 
     if (whdRecord->dataInStreams == 0)
-      filePath = relative(loadPathView.path(), archiveDialog.basePath.path()) / filePath.path();
+      filePath = relative(loadPathView.path(), basePathView.path()) / filePath.path();
     else if (!filePath.native().starts_with("Streams"))
       filePath = L"Streams" / filePathNative;
 
+    parsedRecords.emplace_back(std::move(filePath), whdRecord);
+  }
+
+  dataXXH3 = XXH3_64bits(data.data(), data.size());
+  path = loadPathView;
+
+  return true;
+}
+
+bool Hitman23WHDFile::Load(Hitman23ArchiveDialog& archiveDialog, const StringView8CI &loadPathView)
+{
+  if (header == nullptr && !Parse(loadPathView, archiveDialog.basePath))
+    return false;
+
+  recordMap.clear();
+
+  for (const auto &[filePath, whdRecord] : parsedRecords)
+  {
     auto& file = archiveDialog.GetFile(filePath);
 
     if (!recordMap.try_emplace(file.path, whdRecord).second)
@@ -258,6 +379,7 @@ bool Hitman23WHDFile::Load(Hitman23ArchiveDialog& archiveDialog, const StringVie
     assert(whdRecord->dataInStreams || fileMapEmplaced);
   }
 
+  parsedRecords.clear();
   path = loadPathView;
 
   return true;
@@ -265,13 +387,25 @@ bool Hitman23WHDFile::Load(Hitman23ArchiveDialog& archiveDialog, const StringVie
 
 bool Hitman23WHDFile::Save(const Hitman23WAVFile &streamsWAV, const Hitman23WAVFile &missionWAV, const StringView8CI &savePath)
 {
-  for (auto *whdRecord : recordMap | ranges::views::values)
+  for (const auto &[filePath, whdRecord] : recordMap)
   {
+    // NOTE - data of scene which was not loaded did not change
+    if (whdRecord->dataInStreams == 0 && !missionWAV.loaded)
+      continue;
+
     const auto &wavRecordMap = whdRecord->dataInStreams == 0 ? missionWAV.recordMap : streamsWAV.recordMap;
     const auto wavRecordIt = wavRecordMap.find(whdRecord->dataOffset);
     assert(wavRecordIt != wavRecordMap.end());
     if (wavRecordIt != wavRecordMap.end())
-      whdRecord->dataOffset = wavRecordIt->second.newOffset;
+      whdRecord->dataOffset = wavRecordIt->second.GetNewOffset(filePath);
+  }
+
+  // NOTE - scenes which were not touched are not written again
+  const auto newDataXXH3 = XXH3_64bits(data.data(), data.size());
+  if (newDataXXH3 == dataXXH3 && CopyUnchangedFile(path, savePath))
+  {
+    path = savePath;
+    return true;
   }
 
   const auto oldSync = std::ios_base::sync_with_stdio(false);
@@ -282,6 +416,10 @@ bool Hitman23WHDFile::Save(const Hitman23WAVFile &streamsWAV, const Hitman23WAVF
 
   std::ios_base::sync_with_stdio(oldSync);
 
+  if (!whdData)
+    return false;
+
+  dataXXH3 = newDataXXH3;
   path = savePath;
 
   return true;
@@ -295,6 +433,10 @@ bool Hitman23ArchiveDialog::Clear(const bool retVal)
   basePath.clear();
   fileMap.clear();
   whdRecordsMap.clear();
+  sceneIndexMap.clear();
+  sceneDirectoryMap.clear();
+  sceneMutexes.clear();
+  pendingSceneLoads.clear();
 
   return Glacier1ArchiveDialog::Clear(retVal);
 }
@@ -317,11 +459,115 @@ bool Hitman23ArchiveDialog::ImportSingle(const StringView8CI &importFolderPathVi
     }
   }
 
+  // NOTE - data of the scene has to be loaded before it is replaced
+  const auto sceneIndexIt = sceneIndexMap.find(fileIt->first);
+  if (sceneIndexIt != sceneIndexMap.end() && !LoadScene(sceneIndexIt->second))
+    return false;
+
   if (!ImportSingleHitmanFile(fileIt->second, importFilePathView, options))
     return false;
 
+  UpdateArchiveRecords(fileIt->second);
+
+  return true;
+}
+
+void Hitman23ArchiveDialog::UpdateArchiveRecords(const Glacier1AudioFile &glacier1AudioFile)
+{
+  const auto whdRecordsIt = whdRecordsMap.find(glacier1AudioFile.path);
+  if (whdRecordsIt == whdRecordsMap.end())
+    return;
+
   for (auto* whdRecord : whdRecordsIt->second)
-    whdRecord->FromHitmanSoundRecord(fileIt->second.archiveRecord);
+    whdRecord->FromHitmanSoundRecord(glacier1AudioFile.archiveRecord);
+}
+
+bool Hitman23ArchiveDialog::LoadDeferredData(const Options &)
+{
+  std::vector<size_t> sceneIndices(wavFiles.size());
+  std::iota(sceneIndices.begin(), sceneIndices.end(), 0);
+
+  std::atomic_bool loadFailed = false;
+  std::for_each(std::execution::par, sceneIndices.begin(), sceneIndices.end(), [this, &loadFailed](const size_t sceneIndex)
+  {
+    if (loadFailed.load(std::memory_order_relaxed))
+      return;
+
+    if (!LoadScene(sceneIndex))
+      loadFailed.store(true, std::memory_order_relaxed);
+  });
+
+  return !loadFailed;
+}
+
+void Hitman23ArchiveDialog::OnDirectoryOpened(const ArchiveDirectory &directory)
+{
+  const auto sceneDirectoryIt = sceneDirectoryMap.find(&directory);
+  if (sceneDirectoryIt == sceneDirectoryMap.end())
+    return;
+
+  // NOTE - each scene is requested only once, so scene which failed to load is not tried again on every redraw
+  if (!wavFiles[sceneDirectoryIt->second].loaded)
+    pendingSceneLoads.emplace_back(sceneDirectoryIt->second);
+
+  sceneDirectoryMap.erase(sceneDirectoryIt);
+}
+
+void Hitman23ArchiveDialog::LoadPendingScenes()
+{
+  progressMessage = g_LocalizationManager.Localize("HITMAN_23_DIALOG_LOADING_SCENES");
+  progressNext = 0;
+  progressNextTotal = pendingSceneLoads.size();
+
+  progressTask = std::async(std::launch::async, [this, sceneIndices = std::move(pendingSceneLoads)] {
+    std::for_each(std::execution::par, sceneIndices.begin(), sceneIndices.end(), [this](const size_t sceneIndex)
+    {
+      LoadScene(sceneIndex);
+      ++progressNext;
+    });
+
+    // NOTE - scene which failed to load stays unloaded, errors are reported only once all of them were tried
+    for (const auto sceneIndex : sceneIndices)
+    {
+      if (!wavFiles[sceneIndex].loaded)
+        DisplayError(g_LocalizationManager.LocalizeFormat("HITMAN_23_DIALOG_ERROR_LOADING_SCENE", wavFiles[sceneIndex].path));
+    }
+
+    std::unique_lock progressMessageLock(progressMessageMutex);
+    progressMessage.clear();
+  });
+
+  pendingSceneLoads.clear();
+}
+
+bool Hitman23ArchiveDialog::LoadScene(const size_t sceneIndex)
+{
+  std::unique_lock sceneLock(sceneMutexes[sceneIndex]);
+
+  auto &wavFile = wavFiles[sceneIndex];
+  if (wavFile.loaded)
+    return true;
+
+  const auto &whdFile = whdFiles[sceneIndex];
+  const auto wavFilePath = String8CI(whdFile.path.path().replace_extension(L".wav"));
+  if (!wavFile.Load(wavFilePath, whdFile.recordMap, fileMap, true))
+  {
+    // NOTE - scene which failed to load stays as it is on disk, it is copied on save same as scenes which were not loaded
+    wavFile.path = wavFilePath;
+    wavFile.dirty = false;
+    return false;
+  }
+
+  // NOTE - original records may have been loaded before the data, files could not be compared with them until now
+  for (const auto &[filePath, whdRecord] : whdFile.recordMap)
+  {
+    if (whdRecord->dataInStreams != 0)
+      continue;
+
+    const auto &file = fileMap.at(filePath);
+    if (file.originalRecord.dataXXH3 != 0)
+      GetFile(filePath).original = file.originalRecord == file.archiveRecord;
+  }
 
   return true;
 }
@@ -340,34 +586,64 @@ bool Hitman23ArchiveDialog::LoadImpl(const StringView8CI &loadPathView, const Op
 
   const auto allWHDFiles = GetAllFilesInDirectory(String8CI(scenesPath), ".whd", true);
 
-  whdFiles.reserve(allWHDFiles.size());
-  wavFiles.reserve(allWHDFiles.size());
+  whdFiles.resize(allWHDFiles.size());
+  wavFiles.resize(allWHDFiles.size());
+  sceneMutexes = std::vector<std::mutex>(allWHDFiles.size());
 
   basePath = rootPath;
 
+  // NOTE - scenes are independent, only adding their records into the archive has to be done serially
+  std::vector<size_t> sceneIndices(allWHDFiles.size());
+  std::iota(sceneIndices.begin(), sceneIndices.end(), 0);
+
+  std::atomic_bool loadFailed = false;
+  std::for_each(std::execution::par, sceneIndices.begin(), sceneIndices.end(), [this, &allWHDFiles, &loadFailed](const size_t sceneIndex)
+  {
+    if (loadFailed.load(std::memory_order_relaxed))
+      return;
+
+    if (!whdFiles[sceneIndex].Parse(allWHDFiles[sceneIndex], basePath))
+      loadFailed.store(true, std::memory_order_relaxed);
+  });
+
+  if (loadFailed)
+    return Clear(false);
+
   OrderedMap<StringView8CI, Hitman23WHDRecord *> allWHDRecords;
-  for (const auto &whdPath : allWHDFiles)
+  for (size_t i = 0; i < allWHDFiles.size(); ++i)
   {
-    auto &whdFile = whdFiles.emplace_back();
-    if (!whdFile.Load(*this, whdPath))
+    auto &whdFile = whdFiles[i];
+    if (!whdFile.Load(*this, allWHDFiles[i]))
       return Clear(false);
 
+    auto hasSceneData = false;
     for (const auto& [filePath, whdRecord] : whdFile.recordMap)
     {
       [[maybe_unused]] const auto res = allWHDRecords.try_emplace(filePath, whdRecord);
 
       // TODO - do we want to handle this in some way? duplicates pointing to streams should not be an issue unless offsets are different...
       assert(res.second || (res.first->second->dataInStreams && res.first->second->dataInStreams == whdRecord->dataInStreams && res.first->second->dataOffset == whdRecord->dataOffset));
+
+      if (whdRecord->dataInStreams == 0)
+        hasSceneData |= sceneIndexMap.try_emplace(filePath, i).second;
     }
 
-    if (!wavFiles.emplace_back().Load(String8CI(whdFile.path.path().replace_extension(L".wav")), whdFile.recordMap, fileMap, true))
-      return Clear(false);
+    wavFiles[i].path = String8CI(whdFile.path.path().replace_extension(L".wav"));
+
+    // NOTE - files of the scene are placed in directory named after its WHD file, it exists only when scene stores any data
+    if (hasSceneData)
+      sceneDirectoryMap.try_emplace(&GetDirectory(String8CI(relative(whdFile.path.path(), basePath.path()))), i);
   }
 
+  if (!options.hitman23.loadScenesOnDemand && !LoadDeferredData(options))
+    return Clear(false);
+
   const auto streamsWAVData = ReadWholeBinaryFile(loadPathView);
   if (!streamsWAV.Load(streamsWAVData, allWHDRecords, fileMap, false))
     return Clear(false);
 
+  streamsWAV.path = loadPathView;
+
   auto dataPath = GetUserPath().path();
   if (dataPath.empty())
     return Clear(false);
@@ -389,12 +665,40 @@ bool Hitman23ArchiveDialog::SaveImpl(const StringView8CI &savePathView, const Op
 {
   const auto newBasePath = savePathView.path().parent_path();
 
-  streamsWAV.Save(savePathView);
+  // NOTE - scenes only need offsets of streams records, so streams are written alongside them
+  streamsWAV.Layout();
 
-  for (size_t i = 0; i < whdFiles.size(); ++i)
+  std::vector<uint8_t> saveJobsWritten(whdFiles.size() + 1, false);
+  const auto saved = RunSaveJobs(whdFiles.size() + 1, [this, &savePathView, &newBasePath, &saveJobsWritten](const size_t saveJobIndex)
   {
-    wavFiles[i].Save(String8CI(newBasePath / relative(wavFiles[i].path.path(), basePath.path())));
-    whdFiles[i].Save(streamsWAV, wavFiles[i], String8CI(newBasePath / relative(whdFiles[i].path.path(), basePath.path())));
+    if (saveJobIndex == 0)
+      saveJobsWritten[saveJobIndex] = streamsWAV.Write(savePathView);
+    else
+    {
+      const auto sceneIndex = saveJobIndex - 1;
+      wavFiles[sceneIndex].Layout();
+      saveJobsWritten[saveJobIndex] = wavFiles[sceneIndex].Write(String8CI(newBasePath / relative(wavFiles[sceneIndex].path.path(), basePath.path())))
+        && whdFiles[sceneIndex].Save(streamsWAV, wavFiles[sceneIndex], String8CI(newBasePath / relative(whdFiles[sceneIndex].path.path(), basePath.path())));
+    }
+
+    return saveJobsWritten[saveJobIndex] != 0;
+  });
+
+  // NOTE - records are rekeyed only after all WHD files were patched, as they look records up by offsets from last save,
+  //        files which failed to be written keep their records keyed as they were
+  if (saveJobsWritten.front())
+    streamsWAV.CommitLayout();
+
+  for (size_t sceneIndex = 0; sceneIndex < wavFiles.size(); ++sceneIndex)
+  {
+    if (saveJobsWritten[sceneIndex + 1])
+      wavFiles[sceneIndex].CommitLayout();
+  }
+
+  if (!saved)
+  {
+    DisplayError(g_LocalizationManager.Localize("ARCHIVE_DIALOG_SAVE_ERROR_WRITING_FILES"));
+    return false;
   }
 
   basePath = newBasePath;
@@ -414,6 +718,9 @@ bool Hitman23ArchiveDialog::SaveImpl(const StringView8CI &savePathView, const Op
 
 int32_t Hitman23ArchiveDialog::DrawDialog()
 {
+  if (!pendingSceneLoads.empty() && !IsInProgress())
+    LoadPendingScenes();
+
   return DrawGlacier1ArchiveDialog();
 }
 
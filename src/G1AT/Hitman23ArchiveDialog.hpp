@@ -70,6 +70,11 @@ struct Hitman23WAVRecord
 {
   std::vector<char>& data;
   uint32_t newOffset = 0;
+  const Glacier1AudioRecord *archiveRecord = nullptr; // record of the file owning the data, nullptr for data between files
+  uint64_t savedDataXXH3 = 0; // hash of owned data as it was last loaded or saved
+  std::vector<Glacier1SharedAudioData> sharedData; // other files stored in the same data
+
+  uint32_t GetNewOffset(const StringView8CI &filePath) const;
 };
 
 struct Hitman23WAVFile
@@ -81,25 +86,36 @@ struct Hitman23WAVFile
   bool Load(const StringView8CI &loadPath, const OrderedMap<StringView8CI, Hitman23WHDRecord *> &whdRecordsMap,
             OrderedMap<StringView8CI, Glacier1AudioFile>& fileMap, bool isMissionWAV);
 
+  // Assigns new offsets to records, so WHD files may be patched before the data is written.
+  void Layout();
+  bool Write(const StringView8CI &savePath);
+  // Rekeys records by their new offsets, once every WHD file referencing them was saved.
+  void CommitLayout();
   bool Save(const StringView8CI &savePath);
 
   Hitman23WAVHeader *header = nullptr;
   OrderedMap<uint32_t, Hitman23WAVRecord> recordMap;
   std::list<std::vector<char>> extraData;
   String8CI path;
+  bool dirty = true; // whether last Layout changed any data or offset since file was last loaded or saved
+  bool loaded = false; // scene files may be loaded only once they are needed
 };
 
 struct Hitman23WHDFile
 {
   bool Clear(bool retVal = false);
 
+  // Parses records without touching the archive, so multiple files may be parsed at once. Load adds them afterwards.
+  bool Parse(const StringView8CI &loadPathView, const StringView8CI &basePathView);
   bool Load(Hitman23ArchiveDialog& archiveDialog, const StringView8CI &loadPathView);
 
   bool Save(const Hitman23WAVFile &streamsWAV, const Hitman23WAVFile &missionWAV, const StringView8CI &savePath);
 
   Hitman23WHDHeader *header = nullptr;
   OrderedMap<StringView8CI, Hitman23WHDRecord *> recordMap;
+  std::vector<std::pair<String8CI, Hitman23WHDRecord *>> parsedRecords;
   std::vector<char> data;
+  uint64_t dataXXH3 = 0; // hash of data as it was last loaded or saved
   String8CI path;
 };
 
@@ -110,6 +126,16 @@ public:
 
   bool ImportSingle(const StringView8CI &importFolderPath, const StringView8CI &importFilePath, const Options &options) override;
 
+  void UpdateArchiveRecords(const Glacier1AudioFile &glacier1AudioFile) override;
+
+  bool LoadDeferredData(const Options &options) override;
+  void OnDirectoryOpened(const ArchiveDirectory &directory) override;
+
+  // Loads data of the scene when it was not loaded yet, different scenes may be loaded at once.
+  bool LoadScene(size_t sceneIndex);
+  // Loads scenes whose directories were opened in the tree view, in the background.
+  void LoadPendingScenes();
+
   bool LoadImpl(const StringView8CI &loadPath, const Options &options) override;
 
   bool SaveImpl(const StringView8CI &savePath, const Options &options) override;
@@ -125,6 +151,10 @@ public:
   Hitman23WAVFile streamsWAV;
 
   OrderedMap<StringView8CI, std::vector<Hitman23WHDRecord *>> whdRecordsMap;
+  OrderedMap<StringView8CI, size_t> sceneIndexMap; // index of the scene storing data of the file, streams are not included
+  OrderedMap<const ArchiveDirectory *, size_t> sceneDirectoryMap; // directories of scenes in the tree view
+  std::vector<std::mutex> sceneMutexes;
+  std::vector<size_t> pendingSceneLoads; // scenes to be loaded on next draw, tree view may not change while it is drawn
 
   String8CI basePath;
 };
@@ -11,8 +11,9 @@
 
 #include "Hitman4ArchiveDialog.hpp"
 
-#include <Config/Config.hpp>
-
+#include "Remix.hpp"
+#include "SIMD.hpp"
+#include "Transcode.hpp"
 #include "Utils.hpp"
 
 bool Hitman4STRFile::Clear(const bool retVal)
@@ -49,8 +50,12 @@ bool Hitman4STRFile::Load(Hitman4ArchiveDialog& archiveDialog, const std::vector
 
   wavDataTable.resize(header.entriesCount);
   lipDataTable.resize(header.entriesCount);
+  lipDataIndexTable.resize(header.entriesCount);
+  lipSegmentSizeTable.resize(header.entriesCount);
   wavHeaderTable.resize(header.entriesCount);
   stringTable.resize(header.entriesCount);
+  archiveRecordTable.assign(header.entriesCount, nullptr);
+  savedRecordTable.assign(header.entriesCount, {});
 
   wavHeaderTableBeginOffset = header.offsetToEntryTable;
   stringTableBeginOffset = header.offsetToEntryTable;
@@ -97,12 +102,17 @@ bool Hitman4STRFile::Load(Hitman4ArchiveDialog& archiveDialog, const std::vector
     uint32_t masterId = 0;
     uint32_t firstReferenceId = 0;
     uint32_t secondaryDataId = 0;
+    Glacier1AudioFile* firstReferenceFile = nullptr;
+    Glacier1AudioFile* secondaryDataFile = nullptr;
   };
 
+  // NOTE - data size of aliased master is computed from its sub-records for loading only, stored one stays as it was
+  auto dataRecordTable = recordTable;
+
   OrderedMap<uint64_t, StreamsAliasedRecord> aliasedDataMap;
   for (uint32_t i = 0; i < header.entriesCount; ++i)
   {
-    auto& strRecord = recordTable[i];
+    auto& strRecord = dataRecordTable[i];
     auto& strFilename = stringTable[i];
 
     if (!strFilename.path().extension().empty())
@@ -117,7 +127,7 @@ bool Hitman4STRFile::Load(Hitman4ArchiveDialog& archiveDialog, const std::vector
 
   for (uint32_t i = 0; i < header.entriesCount; ++i)
   {
-    auto& strRecord = recordTable[i];
+    auto& strRecord = dataRecordTable[i];
     auto& strFilename = stringTable[i];
     auto& strWAVHeader = wavHeaderTable[i];
 
@@ -129,7 +139,7 @@ bool Hitman4STRFile::Load(Hitman4ArchiveDialog& archiveDialog, const std::vector
       continue;
 
     auto& streamsAliasedRecord = aliasedDataIt->second;
-    auto& strRecordMaster = recordTable[streamsAliasedRecord.masterId];
+    auto& strRecordMaster = dataRecordTable[streamsAliasedRecord.masterId];
 
     if (strRecord.distanceBasedRecordOrder == 1)
     {
@@ -151,8 +161,101 @@ bool Hitman4STRFile::Load(Hitman4ArchiveDialog& archiveDialog, const std::vector
     strRecordMaster.dataSize += strWAVHeader.samplesCount * sizeof(int16_t);
   }
 
+  // Copies WAV data of the record out of its data block, separating LIP segments from it when there are any.
+  const auto extractData = [&wavData](const STR::v1::Entry& strRecord, const uint64_t wavDataSize, std::vector<char>& strData, std::vector<char>& strLIPData,
+                                      uint64_t& strLIPSegmentSize)
+  {
+    // NOTE - buffers are filled straight from the data block, so they are not zeroed beforehand
+    const auto *strDataBlock = wavData.data() + strRecord.dataOffset;
+    strData.clear();
+    strLIPData.clear();
+    strLIPSegmentSize = 0;
+
+    if (!strRecord.hasLIP)
+    {
+      strData.assign(strDataBlock, strDataBlock + strRecord.dataSize);
+      return true;
+    }
+
+    assert(*reinterpret_cast<const uint32_t*>(strDataBlock) == 0x2050494C);
+
+    const auto lipDataSize = (wavDataSize - strRecord.dataSize) & (~0xFFFull);
+
+    if (lipDataSize <= 0x1000)
+    {
+      strLIPData.assign(strDataBlock, strDataBlock + lipDataSize);
+      strData.assign(strDataBlock + lipDataSize, strDataBlock + lipDataSize + strRecord.dataSize);
+      return true;
+    }
+
+    uint64_t lipSegmentsCount = lipDataSize / 0x1000;
+    assert(lipSegmentsCount * 0x1000 == lipDataSize);
+
+    // NOTE - every LIP segment ends with block of zeroes, so all of them are flagged in single pass first. Segment size must
+    //        also yield exact count of segments in the data block, which limits candidate sizes to narrow range, so each
+    //        of them is checked just against already flagged blocks.
+    static constexpr uint64_t nullBlockSize = 0x0400;
+    const auto lipWindowsCount = (wavDataSize + 0x0FFF) / 0x1000;
+    const auto nullBlocks = FindZeroWindows(wavData.data() + strRecord.dataOffset, wavData.size() - strRecord.dataOffset, 0x1000 - nullBlockSize,
+                                            nullBlockSize, 0x1000, lipWindowsCount);
+
+    uint64_t lipSegmentSize = 0;
+    for (uint64_t lipSegmentBlocks = std::max((wavDataSize + lipSegmentsCount * 0x1000 - 1) / (lipSegmentsCount * 0x1000), uint64_t{1});
+         lipSegmentBlocks * 0x1000 * (lipSegmentsCount - 1) < wavDataSize; ++lipSegmentBlocks)
+    {
+      uint64_t lipSegmentIndex = 1;
+      while (lipSegmentIndex < lipSegmentsCount && nullBlocks[lipSegmentIndex * lipSegmentBlocks])
+        ++lipSegmentIndex;
+
+      if (lipSegmentIndex == lipSegmentsCount)
+      {
+        lipSegmentSize = lipSegmentBlocks * 0x1000;
+        break;
+      }
+    }
+
+    if (lipSegmentSize == 0)
+      return false;
+
+    strLIPData.reserve(lipDataSize);
+    strData.reserve(strRecord.dataSize);
+
+    auto lipBytesLeft = lipDataSize;
+    auto wavBytesLeft = strRecord.dataSize;
+    const uint64_t dataDividerOffset = 0x1000;
+    assert(lipDataSize % dataDividerOffset == 0);
+    for (uint64_t lipSegmentOffset = 0; lipSegmentOffset < wavDataSize; lipSegmentOffset += lipSegmentSize)
+    {
+      const auto lipCopySize = std::min(lipBytesLeft, dataDividerOffset);
+      assert(lipCopySize == dataDividerOffset);
+      strLIPData.insert(strLIPData.end(), strDataBlock + lipSegmentOffset, strDataBlock + lipSegmentOffset + lipCopySize);
+      lipBytesLeft -= lipCopySize;
+
+      const auto wavCopySize = std::min(wavBytesLeft, lipSegmentSize - lipCopySize);
+      strData.insert(strData.end(), strDataBlock + lipSegmentOffset + lipCopySize, strDataBlock + lipSegmentOffset + lipCopySize + wavCopySize);
+      wavBytesLeft -= wavCopySize;
+    }
+
+    strLIPData.resize(lipDataSize, 0);
+    strData.resize(strRecord.dataSize, 0);
+
+    strLIPSegmentSize = lipSegmentSize;
+    return true;
+  };
+
   recordMap.clear();
+  recordPaths.clear();
+
+  // NOTE - entries are planned serially, as they insert into shared maps, their data blocks are then extracted in parallel
+  struct StreamsLoadJob
+  {
+    uint32_t recordId = 0;
+    uint64_t wavDataSize = 0;
+    Glacier1AudioFile* file = nullptr; // nullptr for masters of aliased records, their sub-records are split out at once
+    const StreamsAliasedRecord* aliasedRecord = nullptr;
+  };
 
+  std::vector<StreamsLoadJob> loadJobs;
   std::vector<std::reference_wrapper<Glacier1AudioFile>> strFiles;
   for (uint32_t i = 0; i < header.entriesCount; ++i)
   {
@@ -160,16 +263,20 @@ bool Hitman4STRFile::Load(Hitman4ArchiveDialog& archiveDialog, const std::vector
     auto& strLIPData = lipDataTable[i];
 
     auto strIndex = i;
-    auto strRecord = recordTable[strIndex];
+    auto strRecord = dataRecordTable[strIndex];
     const auto aliasedDataIt = aliasedDataMap.find(strRecord.dataOffset);
     if (aliasedDataIt != aliasedDataMap.end())
     {
-      if (aliasedDataIt->second.masterId == i)
+      strIndex = aliasedDataIt->second.masterId;
+      lipDataIndexTable[i] = strIndex;
+
+      if (strIndex == i)
         continue;
 
-      strIndex = aliasedDataIt->second.masterId;
-      strRecord = recordTable[aliasedDataIt->second.masterId];
+      strRecord = dataRecordTable[strIndex];
     }
+    else
+      lipDataIndexTable[i] = i;
 
     auto& strWAVHeader = wavHeaderTable[strIndex];
 
@@ -186,6 +293,7 @@ bool Hitman4STRFile::Load(Hitman4ArchiveDialog& archiveDialog, const std::vector
       return Clear(false);
 
     auto& glacier1AudioFile = fileMapIt->second;
+    archiveRecordTable[i] = &glacier1AudioFile.archiveRecord;
 
     assert(dataOffsets.contains(strRecord.dataOffset));
     assert(++dataOffsets.find(strRecord.dataOffset) != dataOffsets.end());
@@ -202,263 +310,468 @@ bool Hitman4STRFile::Load(Hitman4ArchiveDialog& archiveDialog, const std::vector
     assert(strWAVHeader.format != STR::v1::DataFormat::DISTANCE_BASED_MASTER || strRecord.dataHeaderSize == 0x18);
     assert(strRecord.id < header.entriesCount);
 
-    glacier1AudioFile.data.resize(strRecord.dataSize);
-    ranges::fill(glacier1AudioFile.data, 0);
     strFiles.emplace_back(glacier1AudioFile);
 
-    if (!strRecord.hasLIP)
+    if (strIndex == i)
     {
-      std::memcpy(glacier1AudioFile.data.data(), wavData.data() + strRecord.dataOffset, strRecord.dataSize);
+      loadJobs.emplace_back(StreamsLoadJob{i, wavDataSize, &glacier1AudioFile});
 
-      if (strIndex == i)
-      {
-        [[maybe_unused]] const auto [recordMapIt, recordMapEmplaced] = recordMap.try_emplace(strRecord.dataOffset, Hitman4WAVRecord{glacier1AudioFile.data, static_cast<uint32_t>(strRecord.dataOffset)});
-        if (!recordMapEmplaced)
-          return Clear(false);
+      const auto recordMapEmplaced = !strRecord.hasLIP
+        ? recordMap.try_emplace(strRecord.dataOffset, Hitman4WAVRecord{glacier1AudioFile.data, static_cast<uint32_t>(strRecord.dataOffset)}).second
+        : recordMap.try_emplace(strRecord.dataOffset, Hitman4WAVRecord{glacier1AudioFile.data, static_cast<uint32_t>(strRecord.dataOffset), strLIPData}).second;
+      if (!recordMapEmplaced)
+        return Clear(false);
 
-        continue;
-      }
+      recordPaths.try_emplace(strRecord.dataOffset, glacier1AudioFile.path);
+      continue;
+    }
+
+    auto& streamsAliasedRecord = aliasedDataIt->second;
+    const auto isFirstReference = i == streamsAliasedRecord.firstReferenceId;
+    auto& strThisSubRecord = dataRecordTable[isFirstReference ? streamsAliasedRecord.firstReferenceId : streamsAliasedRecord.secondaryDataId];
+    auto& strThisWAVHeader = wavHeaderTable[isFirstReference ? streamsAliasedRecord.firstReferenceId : streamsAliasedRecord.secondaryDataId];
 
-      auto& strSub1Record = recordTable[aliasedDataIt->second.firstReferenceId];
-      auto& strSub1WAVHeader = wavHeaderTable[aliasedDataIt->second.firstReferenceId];
-      size_t strSub1DataIndex = 0;
-      auto& strSub2Record = recordTable[aliasedDataIt->second.secondaryDataId];
-      auto& strSub2WAVHeader = wavHeaderTable[aliasedDataIt->second.secondaryDataId];
-      size_t strSub2DataIndex = 0;
+    // NOTE - both sub-records are split out of the master data at once, so only one job is planned for them
+    if (!streamsAliasedRecord.firstReferenceFile && !streamsAliasedRecord.secondaryDataFile)
+    {
+      assert(dataRecordTable[streamsAliasedRecord.firstReferenceId].dataSize + dataRecordTable[streamsAliasedRecord.secondaryDataId].dataSize <= strRecord.dataSize);
+      if (dataRecordTable[streamsAliasedRecord.firstReferenceId].dataSize + dataRecordTable[streamsAliasedRecord.secondaryDataId].dataSize > strRecord.dataSize)
+        return Clear(false);
 
-      assert(strSub1WAVHeader.sampleRate >= strSub2WAVHeader.sampleRate);
-      assert(strSub1WAVHeader.channels >= strSub2WAVHeader.channels);
-      const auto samplesBlockSecondaryDataOffset = (strSub1WAVHeader.sampleRate / strSub2WAVHeader.sampleRate) * (strSub1WAVHeader.channels / strSub2WAVHeader.channels) * sizeof(int16_t);
-      const auto samplesBlockSecondaryDataSize = strSub2WAVHeader.channels * sizeof(int16_t);
+      loadJobs.emplace_back(StreamsLoadJob{strIndex, wavDataSize, nullptr, &streamsAliasedRecord});
+    }
 
-      auto& strThisSubRecord = (i == aliasedDataIt->second.firstReferenceId) ? strSub1Record : strSub2Record;
-      auto& strThisWAVHeader = (i == aliasedDataIt->second.firstReferenceId) ? strSub1WAVHeader : strSub2WAVHeader;
-      auto& strThisDataIndex = (i == aliasedDataIt->second.firstReferenceId) ? strSub1DataIndex : strSub2DataIndex;
-      auto& strThisSamplesBlockSize = (i == aliasedDataIt->second.firstReferenceId) ? samplesBlockSecondaryDataOffset : samplesBlockSecondaryDataSize;
+    (isFirstReference ? streamsAliasedRecord.firstReferenceFile : streamsAliasedRecord.secondaryDataFile) = &glacier1AudioFile;
 
-      if (i == aliasedDataIt->second.secondaryDataId)
-        strSub1DataIndex += samplesBlockSecondaryDataOffset;
+    glacier1AudioFile.archiveRecord = strThisWAVHeader.ToBaseDataInfo();
+    glacier1AudioFile.archiveRecord.dataSize = static_cast<uint32_t>(strThisSubRecord.dataSize);
 
-      assert(strSub1Record.dataSize + strSub2Record.dataSize <= strRecord.dataSize);
-      while (strThisDataIndex < strThisSubRecord.dataSize)
-      {
-        std::memmove(glacier1AudioFile.data.data() + strThisDataIndex, glacier1AudioFile.data.data() + strSub1DataIndex + strSub2DataIndex, std::min(strThisSubRecord.dataSize - strThisDataIndex, strThisSamplesBlockSize));
-        strSub1DataIndex = std::min(strSub1DataIndex + samplesBlockSecondaryDataOffset, strSub1Record.dataSize);
-        strSub2DataIndex = std::min(strSub2DataIndex + samplesBlockSecondaryDataSize, strSub2Record.dataSize);
-      }
+    const auto recordKey = strRecord.dataOffset | (strThisSubRecord.distanceBasedRecordOrder & 0xFF);
+    [[maybe_unused]] const auto [recordMapIt, recordMapEmplaced] = recordMap.try_emplace(recordKey, Hitman4WAVRecord{glacier1AudioFile.data, static_cast<uint32_t>(strRecord.dataOffset)});
+    if (!recordMapEmplaced)
+      return Clear(false);
 
-      glacier1AudioFile.data.resize(strThisSubRecord.dataSize);
-      glacier1AudioFile.archiveRecord = strThisWAVHeader.ToBaseDataInfo();
-      glacier1AudioFile.archiveRecord.dataSize = static_cast<uint32_t>(strThisSubRecord.dataSize);
+    recordPaths.try_emplace(recordKey, glacier1AudioFile.path);
+  }
 
-      [[maybe_unused]] const auto [recordMapIt, recordMapEmplaced] = recordMap.try_emplace(strRecord.dataOffset | (strThisSubRecord.distanceBasedRecordOrder & 0xFF), Hitman4WAVRecord{glacier1AudioFile.data, static_cast<uint32_t>(strRecord.dataOffset)});
-      if (!recordMapEmplaced)
-        return Clear(false);
+  ranges::stable_sort(loadJobs, std::greater{}, [&dataRecordTable](const StreamsLoadJob& loadJob) { return dataRecordTable[loadJob.recordId].dataSize; });
 
-      continue;
+  std::atomic_bool loadFailed = false;
+  std::for_each(std::execution::par, loadJobs.begin(), loadJobs.end(), [this, &dataRecordTable, &extractData, &loadFailed](const StreamsLoadJob& loadJob)
+  {
+    if (loadFailed.load(std::memory_order_relaxed))
+      return;
+
+    const auto& strRecord = dataRecordTable[loadJob.recordId];
+    if (!loadJob.aliasedRecord)
+    {
+      if (!extractData(strRecord, loadJob.wavDataSize, loadJob.file->data, lipDataTable[loadJob.recordId], lipSegmentSizeTable[loadJob.recordId]))
+        loadFailed.store(true, std::memory_order_relaxed);
+
+      return;
     }
 
-    assert(*reinterpret_cast<const uint32_t*>(wavData.data() + strRecord.dataOffset) == 0x2050494C);
+    const auto& streamsAliasedRecord = *loadJob.aliasedRecord;
+    if (!streamsAliasedRecord.firstReferenceFile || !streamsAliasedRecord.secondaryDataFile)
+    {
+      assert(false);
+      loadFailed.store(true, std::memory_order_relaxed);
+      return;
+    }
 
-    // TODO - LIP data should be copied only into entry which has it if strIndex != i
-    const auto lipDataSize = (wavDataSize - strRecord.dataSize) & (~0xFFFull);
-    strLIPData.resize(lipDataSize);
-    ranges::fill(strLIPData, 0);
+    const auto& strSub1Record = dataRecordTable[streamsAliasedRecord.firstReferenceId];
+    const auto& strSub1WAVHeader = wavHeaderTable[streamsAliasedRecord.firstReferenceId];
+    const auto& strSub2Record = dataRecordTable[streamsAliasedRecord.secondaryDataId];
+    const auto& strSub2WAVHeader = wavHeaderTable[streamsAliasedRecord.secondaryDataId];
 
-    if (lipDataSize <= 0x1000)
+    // NOTE - LIP data is kept only in master, sub-records which have it resolve to it through GetLIPData
+    std::vector<char> masterData;
+    if (!extractData(strRecord, loadJob.wavDataSize, masterData, lipDataTable[loadJob.recordId], lipSegmentSizeTable[loadJob.recordId]))
     {
-      std::memcpy(strLIPData.data(), wavData.data() + strRecord.dataOffset, lipDataSize);
-      std::memcpy(glacier1AudioFile.data.data(), wavData.data() + strRecord.dataOffset + lipDataSize, strRecord.dataSize);
+      loadFailed.store(true, std::memory_order_relaxed);
+      return;
+    }
 
-      if (strIndex == i)
-      {
-        [[maybe_unused]] const auto [recordMapIt, recordMapEmplaced] = recordMap.try_emplace(strRecord.dataOffset, Hitman4WAVRecord{glacier1AudioFile.data, static_cast<uint32_t>(strRecord.dataOffset)});
-        if (!recordMapEmplaced)
-          return Clear(false);
+    assert(strSub1WAVHeader.sampleRate >= strSub2WAVHeader.sampleRate);
+    assert(strSub1WAVHeader.channels >= strSub2WAVHeader.channels);
+    const auto samplesBlockSecondaryDataOffset = (strSub1WAVHeader.sampleRate / strSub2WAVHeader.sampleRate) * (strSub1WAVHeader.channels / strSub2WAVHeader.channels) * sizeof(int16_t);
+    const auto samplesBlockSecondaryDataSize = strSub2WAVHeader.channels * sizeof(int16_t);
 
-        continue;
-      }
+    auto& strSub1Data = streamsAliasedRecord.firstReferenceFile->data;
+    auto& strSub2Data = streamsAliasedRecord.secondaryDataFile->data;
+    strSub1Data.resize(strSub1Record.dataSize);
+    strSub2Data.resize(strSub2Record.dataSize);
 
-      auto& strSub1Record = recordTable[aliasedDataIt->second.firstReferenceId];
-      auto& strSub1WAVHeader = wavHeaderTable[aliasedDataIt->second.firstReferenceId];
-      size_t strSub1DataIndex = 0;
-      auto& strSub2Record = recordTable[aliasedDataIt->second.secondaryDataId];
-      auto& strSub2WAVHeader = wavHeaderTable[aliasedDataIt->second.secondaryDataId];
-      size_t strSub2DataIndex = 0;
+    PCMS16SplitInterleavedBlocks(masterData.data(), samplesBlockSecondaryDataOffset, samplesBlockSecondaryDataSize, strSub1Data.data(), strSub1Data.size(),
+                                 strSub2Data.data(), strSub2Data.size());
+  });
 
-      assert(strSub1WAVHeader.sampleRate >= strSub2WAVHeader.sampleRate);
-      assert(strSub1WAVHeader.channels >= strSub2WAVHeader.channels);
-      const auto samplesBlockSecondaryDataOffset = (strSub1WAVHeader.sampleRate / strSub2WAVHeader.sampleRate) * (strSub1WAVHeader.channels / strSub2WAVHeader.channels) * sizeof(int16_t);
-      const auto samplesBlockSecondaryDataSize = strSub2WAVHeader.channels * sizeof(int16_t);
+  if (loadFailed)
+    return Clear(false);
 
-      auto& strThisSubRecord = (i == aliasedDataIt->second.firstReferenceId) ? strSub1Record : strSub2Record;
-      auto& strThisWAVHeader = (i == aliasedDataIt->second.firstReferenceId) ? strSub1WAVHeader : strSub2WAVHeader;
-      auto& strThisDataIndex = (i == aliasedDataIt->second.firstReferenceId) ? strSub1DataIndex : strSub2DataIndex;
-      auto& strThisSamplesBlockSize = (i == aliasedDataIt->second.firstReferenceId) ? samplesBlockSecondaryDataOffset : samplesBlockSecondaryDataSize;
+  std::atomic_bool importFailed = false;
+  std::for_each(std::execution::par, strFiles.begin(), strFiles.end(), [this, &importFailed](auto& glacier1AudioFileRef)
+  {
+    if (importFailed.load(std::memory_order_relaxed))
+      return;
 
-      if (i == aliasedDataIt->second.secondaryDataId)
-        strSub1DataIndex += samplesBlockSecondaryDataOffset;
+    auto& glacier1AudioFile = glacier1AudioFileRef.get();
+    auto updatedSoundRecord = HashedSoundRecord(glacier1AudioFile.archiveRecord, {glacier1AudioFile.data.data(), glacier1AudioFile.data.size()});
+    importFailed.store(importFailed.load(std::memory_order_relaxed) || updatedSoundRecord.dataXXH3 == 0);
+    glacier1AudioFile.archiveRecord = std::move(updatedSoundRecord);
+  });
 
-      assert(strSub1Record.dataSize + strSub2Record.dataSize <= strRecord.dataSize);
-      while (strThisDataIndex < strThisSubRecord.dataSize)
-      {
-        std::memmove(glacier1AudioFile.data.data() + strThisDataIndex, glacier1AudioFile.data.data() + strSub1DataIndex + strSub2DataIndex, std::min(strThisSubRecord.dataSize - strThisDataIndex, strThisSamplesBlockSize));
-        strSub1DataIndex = std::min(strSub1DataIndex + samplesBlockSecondaryDataOffset, strSub1Record.dataSize);
-        strSub2DataIndex = std::min(strSub2DataIndex + samplesBlockSecondaryDataSize, strSub2Record.dataSize);
-      }
+  if (importFailed)
+    return Clear(false);
 
-      glacier1AudioFile.data.resize(strThisSubRecord.dataSize);
-      glacier1AudioFile.archiveRecord = strThisWAVHeader.ToBaseDataInfo();
-      glacier1AudioFile.archiveRecord.dataSize = static_cast<uint32_t>(strThisSubRecord.dataSize);
+  if (recordMap.empty())
+    return Clear(false);
 
-      if (!strThisSubRecord.hasLIP)
-        strLIPData.clear();
+  for (uint32_t i = 0; i < header.entriesCount; ++i)
+  {
+    if (archiveRecordTable[i])
+      savedRecordTable[i] = *archiveRecordTable[i];
+  }
 
-      [[maybe_unused]] const auto [recordMapIt, recordMapEmplaced] = recordMap.try_emplace(strRecord.dataOffset | (strThisSubRecord.distanceBasedRecordOrder & 0xFF), Hitman4WAVRecord{glacier1AudioFile.data, static_cast<uint32_t>(strRecord.dataOffset)});
-      if (!recordMapEmplaced)
-        return Clear(false);
+  return true;
+}
 
-      continue;
-    }
+const std::vector<char> &Hitman4STRFile::GetLIPData(const size_t index) const
+{
+  static const std::vector<char> noLIPData;
+  if (index >= recordTable.size() || !recordTable[index].hasLIP)
+    return noLIPData;
 
-    uint64_t lipSegmentsCount = lipDataSize / 0x1000;
-    assert(lipSegmentsCount * 0x1000 == lipDataSize);
+  return lipDataTable[lipDataIndexTable[index]];
+}
 
-    uint64_t lipSegmentSize = 0;
-    for (uint64_t lipIndex = 0x1000; lipIndex < wavDataSize; lipIndex += 0x1000)
+const STR::v1::DataHeader *Hitman4STRFile::GetAliasedDataHeader(const StringView8CI &filePath) const
+{
+  if (filePath.native().size() <= 8)
+    return nullptr;
+
+  const auto indexIt = fileNameToIndex.find(StringView8CI(filePath.native().substr(8)));
+  if (indexIt == fileNameToIndex.end())
+    return nullptr;
+
+  // NOTE - only sub-records of aliased entries point to LIP data of another entry, their master
+  const auto index = indexIt->second;
+  return lipDataIndexTable[index] != index ? &wavHeaderTable[index] : nullptr;
+}
+
+bool Hitman4STRFile::Load(Hitman4ArchiveDialog& archiveDialog, const StringView8CI &loadPath)
+{
+  if (!Load(archiveDialog, ReadWholeBinaryFile(loadPath)))
+    return false;
+
+  path = loadPath;
+  return true;
+}
+
+OrderedMap<uint64_t, std::vector<uint32_t>> Hitman4STRFile::GetDataOffsetEntries() const
+{
+  OrderedMap<uint64_t, std::vector<uint32_t>> dataOffsetEntries;
+  for (uint32_t i = 0; i < header.entriesCount; ++i)
+    dataOffsetEntries[recordTable[i].dataOffset].emplace_back(i);
+
+  return dataOffsetEntries;
+}
+
+void Hitman4STRFile::Layout()
+{
+  savedDataOffsets.clear();
+
+  uint64_t offset = sizeof(STR::v1::Header);
+  if (header.dataBeginOffset != 0)
+    offset = (offset + header.dataBeginOffset - 1) / header.dataBeginOffset * header.dataBeginOffset;
+
+  for (const auto &[dataOffset, entryIndices] : GetDataOffsetEntries())
+  {
+    savedDataOffsets.try_emplace(dataOffset, offset);
+
+    // NOTE - sub-records of aliased entries share LIP data of their master
+    uint64_t lipDataSize = 0;
+    for (const auto strIndex : entryIndices)
+      lipDataSize = std::max<uint64_t>(lipDataSize, GetLIPData(strIndex).size());
+
+    uint64_t dataSize = 0;
+    for (const auto recordOffset : {dataOffset, dataOffset | 1, dataOffset | 2})
     {
-      static constexpr std::array<char, 0x0400> nullBlock = {};
-      if (std::memcmp(wavData.data() + strRecord.dataOffset + lipIndex + 0x0100 + (0x0F00 -nullBlock.size()), nullBlock.data(), nullBlock.size()) == 0)
-      {
-        lipSegmentSize = lipIndex;
-
-        uint64_t foundSegments = 2;
-        for (uint64_t lipSegmentOffset = lipSegmentSize * 2; lipSegmentOffset < wavDataSize; lipSegmentOffset += lipSegmentSize, ++foundSegments)
-        {
-          if (std::memcmp(wavData.data() + strRecord.dataOffset + lipSegmentOffset + 0x0100 + (0x0F00 - nullBlock.size()), nullBlock.data(), nullBlock.size()) != 0)
-          {
-            foundSegments = 0;
-            break;
-          }
-        }
-
-        if (foundSegments != lipSegmentsCount)
-          lipSegmentSize = 0;
-
-        if (lipSegmentSize)
-          break;
-      }
+      const auto recordIt = recordMap.find(recordOffset);
+      if (recordIt != recordMap.end())
+        dataSize += recordIt->second.data.size();
     }
 
-    if (lipSegmentSize == 0)
-      return Clear(false);
+    offset = (offset + lipDataSize + dataSize + 0xFF) & ~uint64_t{0xFF};
+  }
+}
 
-    auto lipBytesLeft = lipDataSize;
-    auto wavBytesLeft = strRecord.dataSize;
-    uint64_t lipDataWriteOffset = 0;
-    uint64_t wavDataWriteOffset = 0;
-    const uint64_t dataDividerOffset = 0x1000;
-    assert(lipDataSize % dataDividerOffset == 0);
-    for (uint64_t lipSegmentOffset = 0; lipSegmentOffset < wavDataSize; lipSegmentOffset += lipSegmentSize)
+bool Hitman4STRFile::Write(const StringView8CI &savePathView)
+{
+  // NOTE - data blocks are written in their original order, sub-records of aliased entries are merged back into master
+  const auto dataOffsetEntries = GetDataOffsetEntries();
+
+  const auto savePath = savePathView.path();
+  create_directories(savePath.parent_path());
+
+  const auto oldSync = std::ios_base::sync_with_stdio(false);
+
+  std::ofstream strData(savePath, std::ios::binary | std::ios::trunc);
+
+  const auto saveFailed = [oldSync]
+  {
+    std::ios_base::sync_with_stdio(oldSync);
+    return false;
+  };
+
+  if (!strData)
+    return saveFailed();
+
+  static constexpr std::array<char, 0x1000> paddingBytes = {};
+  uint64_t offset = 0;
+  const auto writeBytes = [&strData, &offset](const char *bytes, const uint64_t size)
+  {
+    strData.write(bytes, static_cast<int64_t>(size));
+    offset += size;
+  };
+
+  const auto writePadding = [&writeBytes, &offset](const uint64_t alignment)
+  {
+    while (offset % alignment != 0)
+      writeBytes(paddingBytes.data(), std::min<uint64_t>(alignment - offset % alignment, paddingBytes.size()));
+  };
+
+  // Interleaves LIP segments back into the data, each segment apart from the last one is followed by same amount of data as before.
+  const auto writeDataBlock = [&writeBytes, &writePadding](const std::vector<char> &data, const std::vector<char> &lipData, const uint64_t lipSegmentSize)
+  {
+    uint64_t dataWriteOffset = 0;
+    for (uint64_t lipReadOffset = 0; lipReadOffset < lipData.size(); lipReadOffset += 0x1000)
     {
-      const auto lipCopySize = std::min(lipBytesLeft, dataDividerOffset);
-      assert(lipCopySize == dataDividerOffset);
-      std::memcpy(strLIPData.data() + lipDataWriteOffset, wavData.data() + strRecord.dataOffset + lipSegmentOffset, lipCopySize);
-      lipDataWriteOffset += lipCopySize;
-      lipBytesLeft -= lipCopySize;
+      writeBytes(lipData.data() + lipReadOffset, std::min<uint64_t>(0x1000, lipData.size() - lipReadOffset));
 
-      const auto wavCopySize = std::min(wavBytesLeft, lipSegmentSize - lipCopySize);
-      std::memcpy(glacier1AudioFile.data.data() + wavDataWriteOffset, wavData.data() + strRecord.dataOffset + lipSegmentOffset + lipCopySize, wavCopySize);
-      wavDataWriteOffset += wavCopySize;
-      wavBytesLeft -= wavCopySize;
+      const auto isLastSegment = lipReadOffset + 0x1000 >= lipData.size();
+      const auto dataCopySize = isLastSegment || lipSegmentSize <= 0x1000 ? data.size() - dataWriteOffset
+                                                                           : std::min<uint64_t>(data.size() - dataWriteOffset, lipSegmentSize - 0x1000);
+      writeBytes(data.data() + dataWriteOffset, dataCopySize);
+      dataWriteOffset += dataCopySize;
     }
 
-    if (strIndex == i)
+    writeBytes(data.data() + dataWriteOffset, data.size() - dataWriteOffset);
+    writePadding(0x0100);
+  };
+
+  writeBytes(reinterpret_cast<const char *>(&header), sizeof(STR::v1::Header));
+  if (header.dataBeginOffset != 0)
+    writePadding(header.dataBeginOffset);
+
+  OrderedMap<uint64_t, Hitman4WAVRecord> newRecordMap;
+  OrderedMap<uint64_t, StringView8CI> newRecordPaths;
+  const auto emplaceNewRecord = [this, &newRecordMap, &newRecordPaths](const uint64_t recordKey, const uint64_t newRecordKey, Hitman4WAVRecord newRecord)
+  {
+    newRecordMap.try_emplace(newRecordKey, std::move(newRecord));
+
+    const auto recordPathIt = recordPaths.find(recordKey);
+    if (recordPathIt != recordPaths.end())
+      newRecordPaths.try_emplace(newRecordKey, recordPathIt->second);
+  };
+
+  std::vector<char> masterData;
+  for (const auto &[dataOffset, entryIndices] : dataOffsetEntries)
+  {
+    const auto newDataOffset = offset;
+    const auto savedDataOffsetIt = savedDataOffsets.find(dataOffset);
+    assert(savedDataOffsetIt != savedDataOffsets.end() && savedDataOffsetIt->second == newDataOffset);
+    if (savedDataOffsetIt == savedDataOffsets.end() || savedDataOffsetIt->second != newDataOffset)
+      return saveFailed();
+
+    if (entryIndices.size() == 1)
     {
-      [[maybe_unused]] const auto [recordMapIt, recordMapEmplaced] = recordMap.try_emplace(static_cast<uint32_t>(strRecord.dataOffset), Hitman4WAVRecord{glacier1AudioFile.data, static_cast<uint32_t>(strRecord.dataOffset), strLIPData});
-      if (!recordMapEmplaced)
-        return Clear(false);
+      const auto strIndex = entryIndices.front();
+      auto &strRecord = recordTable[strIndex];
+
+      const auto recordIt = recordMap.find(dataOffset);
+      assert(recordIt != recordMap.end());
+      if (recordIt == recordMap.end())
+        return saveFailed();
+
+      auto &record = recordIt->second;
+      writeDataBlock(record.data, GetLIPData(strIndex), lipSegmentSizeTable[strIndex]);
 
+      strRecord.dataOffset = newDataOffset;
+      strRecord.dataSize = record.data.size();
+
+      emplaceNewRecord(dataOffset, newDataOffset, Hitman4WAVRecord{record.data, static_cast<uint32_t>(newDataOffset), record.lipData});
       continue;
     }
 
-    auto& strSub1Record = recordTable[aliasedDataIt->second.firstReferenceId];
-    auto& strSub1WAVHeader = wavHeaderTable[aliasedDataIt->second.firstReferenceId];
-    size_t strSub1DataIndex = 0;
-    auto& strSub2Record = recordTable[aliasedDataIt->second.secondaryDataId];
-    auto& strSub2WAVHeader = wavHeaderTable[aliasedDataIt->second.secondaryDataId];
-    size_t strSub2DataIndex = 0;
+    assert(entryIndices.size() == 3);
+    if (entryIndices.size() != 3)
+      return saveFailed();
 
-    assert(strSub1WAVHeader.sampleRate >= strSub2WAVHeader.sampleRate);
-    assert(strSub1WAVHeader.channels >= strSub2WAVHeader.channels);
+    uint32_t strMasterIndex = 0;
+    uint32_t strSub1Index = 0;
+    uint32_t strSub2Index = 0;
+    for (const auto strIndex : entryIndices)
+    {
+      if (stringTable[strIndex].path().extension().empty())
+        strMasterIndex = strIndex;
+      else if (recordTable[strIndex].distanceBasedRecordOrder == 1)
+        strSub1Index = strIndex;
+      else
+        strSub2Index = strIndex;
+    }
+
+    const auto sub1RecordIt = recordMap.find(dataOffset | 1);
+    const auto sub2RecordIt = recordMap.find(dataOffset | 2);
+    assert(sub1RecordIt != recordMap.end() && sub2RecordIt != recordMap.end());
+    if (sub1RecordIt == recordMap.end() || sub2RecordIt == recordMap.end())
+      return saveFailed();
+
+    auto &sub1Record = sub1RecordIt->second;
+    auto &sub2Record = sub2RecordIt->second;
+
+    const auto &strSub1WAVHeader = wavHeaderTable[strSub1Index];
+    const auto &strSub2WAVHeader = wavHeaderTable[strSub2Index];
     const auto samplesBlockSecondaryDataOffset = (strSub1WAVHeader.sampleRate / strSub2WAVHeader.sampleRate) * (strSub1WAVHeader.channels / strSub2WAVHeader.channels) * sizeof(int16_t);
     const auto samplesBlockSecondaryDataSize = strSub2WAVHeader.channels * sizeof(int16_t);
 
-    auto& strThisSubRecord = (i == aliasedDataIt->second.firstReferenceId) ? strSub1Record : strSub2Record;
-    auto& strThisWAVHeader = (i == aliasedDataIt->second.firstReferenceId) ? strSub1WAVHeader : strSub2WAVHeader;
-    auto& strThisDataIndex = (i == aliasedDataIt->second.firstReferenceId) ? strSub1DataIndex : strSub2DataIndex;
-    auto& strThisSamplesBlockSize = (i == aliasedDataIt->second.firstReferenceId) ? samplesBlockSecondaryDataOffset : samplesBlockSecondaryDataSize;
+    masterData.resize(sub1Record.data.size() + sub2Record.data.size());
+    PCMS16MergeInterleavedBlocks(sub1Record.data.data(), sub1Record.data.size(), sub2Record.data.data(), sub2Record.data.size(), samplesBlockSecondaryDataOffset,
+                                 samplesBlockSecondaryDataSize, masterData.data());
+
+    // NOTE - LIP data of aliased entries is kept in master even when master itself is not flagged to have it, see Layout
+    writeDataBlock(masterData, lipDataTable[strMasterIndex], lipSegmentSizeTable[strMasterIndex]);
+
+    for (const auto strIndex : entryIndices)
+      recordTable[strIndex].dataOffset = newDataOffset;
 
-    if (i == aliasedDataIt->second.secondaryDataId)
-      strSub1DataIndex += samplesBlockSecondaryDataOffset;
+    // NOTE - stored data size of master is kept as it was loaded unless sizes of its sub-records changed
+    if (recordTable[strSub1Index].dataSize != sub1Record.data.size() || recordTable[strSub2Index].dataSize != sub2Record.data.size())
+      recordTable[strMasterIndex].dataSize = masterData.size();
+
+    recordTable[strSub1Index].dataSize = sub1Record.data.size();
+    recordTable[strSub2Index].dataSize = sub2Record.data.size();
+
+    emplaceNewRecord(dataOffset | 1, newDataOffset | 1, Hitman4WAVRecord{sub1Record.data, static_cast<uint32_t>(newDataOffset)});
+    emplaceNewRecord(dataOffset | 2, newDataOffset | 2, Hitman4WAVRecord{sub2Record.data, static_cast<uint32_t>(newDataOffset)});
+  }
 
-    assert(strSub1Record.dataSize + strSub2Record.dataSize <= strRecord.dataSize);
-    while (strThisDataIndex < strThisSubRecord.dataSize)
+  // NOTE - WAV headers of entries whose files changed since last load or save are rebuilt from their records, each of
+  //        them gets its own slot after all unchanged headers
+  std::vector<uint32_t> rebuiltDataHeaderEntries;
+  for (uint32_t i = 0; i < header.entriesCount; ++i)
+  {
+    if (!archiveRecordTable[i] || *archiveRecordTable[i] == savedRecordTable[i])
+      continue;
+
+    auto &strWAVHeader = wavHeaderTable[i];
+    strWAVHeader.FromBaseDataInfo(*archiveRecordTable[i]);
+
+    switch (strWAVHeader.format)
     {
-      std::memmove(glacier1AudioFile.data.data() + strThisDataIndex, glacier1AudioFile.data.data() + strSub1DataIndex + strSub2DataIndex, std::min(strThisSubRecord.dataSize - strThisDataIndex, strThisSamplesBlockSize));
-      strSub1DataIndex = std::min(strSub1DataIndex + samplesBlockSecondaryDataOffset, strSub1Record.dataSize);
-      strSub2DataIndex = std::min(strSub2DataIndex + samplesBlockSecondaryDataSize, strSub2Record.dataSize);
+      case STR::v1::DataFormat::PCM_S16: {
+        recordTable[i].dataHeaderSize = 24;
+        break;
+      }
+      case STR::v1::DataFormat::IMA_ADPCM: {
+        recordTable[i].dataHeaderSize = 0x1c;
+        break;
+      }
+      case STR::v1::DataFormat::OGG_VORBIS: {
+        recordTable[i].dataHeaderSize = 20;
+        break;
+      }
+      default: {
+        assert(false);
+        return saveFailed();
+      }
     }
 
-    glacier1AudioFile.data.resize(strThisSubRecord.dataSize);
-    glacier1AudioFile.archiveRecord = strThisWAVHeader.ToBaseDataInfo();
-    glacier1AudioFile.archiveRecord.dataSize = static_cast<uint32_t>(strThisSubRecord.dataSize);
+    rebuiltDataHeaderEntries.emplace_back(i);
+  }
 
-    if (!strSub1Record.hasLIP)
-      strLIPData.clear();
+  // NOTE - tables keep their original order, shared WAV headers and file names stay shared
+  OrderedMap<uint64_t, uint32_t> dataHeaderEntries;
+  OrderedMap<uint64_t, uint32_t> fileNameEntries;
+  for (uint32_t i = 0; i < header.entriesCount; ++i)
+  {
+    if (!archiveRecordTable[i] || *archiveRecordTable[i] == savedRecordTable[i])
+      dataHeaderEntries.try_emplace(recordTable[i].dataHeaderOffset, i);
 
-    [[maybe_unused]] const auto [recordMapIt, recordMapEmplaced] = recordMap.try_emplace(strRecord.dataOffset | (strThisSubRecord.distanceBasedRecordOrder & 0xFF), Hitman4WAVRecord{glacier1AudioFile.data, static_cast<uint32_t>(strRecord.dataOffset)});
-    if (!recordMapEmplaced)
-      return Clear(false);
+    fileNameEntries.try_emplace(recordTable[i].fileNameOffset, i);
   }
 
-  std::atomic_bool importFailed = false;
-  std::for_each(std::execution::par, strFiles.begin(), strFiles.end(), [this, &importFailed](auto& glacier1AudioFileRef)
+  OrderedMap<uint64_t, uint64_t> newDataHeaderOffsets;
+  wavHeaderTableBeginOffset = offset;
+  for (const auto &[dataHeaderOffset, strIndex] : dataHeaderEntries)
   {
-    if (importFailed.load(std::memory_order_relaxed))
-      return;
+    newDataHeaderOffsets.try_emplace(dataHeaderOffset, offset);
+    writeBytes(reinterpret_cast<const char *>(&wavHeaderTable[strIndex]), recordTable[strIndex].dataHeaderSize);
+  }
 
-    auto& glacier1AudioFile = glacier1AudioFileRef.get();
-    auto updatedSoundRecord = SoundDataSoundRecord(glacier1AudioFile.archiveRecord, {glacier1AudioFile.data.data(), glacier1AudioFile.data.size()});
-    importFailed.store(importFailed.load(std::memory_order_relaxed) || updatedSoundRecord.dataXXH3 == 0);
-    glacier1AudioFile.archiveRecord = std::move(updatedSoundRecord);
-  });
+  for (const auto strIndex : rebuiltDataHeaderEntries)
+  {
+    recordTable[strIndex].dataHeaderOffset = offset;
+    writeBytes(reinterpret_cast<const char *>(&wavHeaderTable[strIndex]), recordTable[strIndex].dataHeaderSize);
+  }
 
-  if (importFailed)
-    return Clear(false);
+  OrderedMap<uint64_t, uint64_t> newFileNameOffsets;
+  stringTableBeginOffset = offset;
+  for (const auto &[fileNameOffset, strIndex] : fileNameEntries)
+  {
+    newFileNameOffsets.try_emplace(fileNameOffset, offset);
+    writeBytes(stringTable[strIndex].data(), recordTable[strIndex].fileNameLength);
+    writeBytes(paddingBytes.data(), 1);
+  }
 
-  if (recordMap.empty())
-    return Clear(false);
+  for (uint32_t i = 0; i < header.entriesCount; ++i)
+  {
+    auto &strRecord = recordTable[i];
+    if (!archiveRecordTable[i] || *archiveRecordTable[i] == savedRecordTable[i])
+      strRecord.dataHeaderOffset = newDataHeaderOffsets.at(strRecord.dataHeaderOffset);
+    else
+      savedRecordTable[i] = *archiveRecordTable[i];
 
-  return true;
-}
+    strRecord.fileNameOffset = newFileNameOffsets.at(strRecord.fileNameOffset);
+  }
 
-bool Hitman4STRFile::Load(Hitman4ArchiveDialog& archiveDialog, const StringView8CI &loadPath)
-{
-  if (!Load(archiveDialog, ReadWholeBinaryFile(loadPath)))
+  header.offsetToEntryTable = static_cast<uint32_t>(offset);
+  writeBytes(reinterpret_cast<const char *>(recordTable.data()), recordTable.size() * sizeof(STR::v1::Entry));
+
+  strData.seekp(0);
+  strData.write(reinterpret_cast<const char *>(&header), sizeof(STR::v1::Header));
+  strData.close();
+
+  std::ios_base::sync_with_stdio(oldSync);
+
+  if (!strData)
     return false;
 
-  path = loadPath;
+  recordMap = std::move(newRecordMap);
+  recordPaths = std::move(newRecordPaths);
+  path = savePathView;
+
   return true;
 }
 
-bool Hitman4STRFile::Save(const StringView8CI &savePath)
+bool Hitman4STRFile::Save(const StringView8CI &savePathView)
 {
-  assert(false);
-  return false;
+  Layout();
+  return Write(savePathView);
 }
 
 
+uint32_t Hitman4WAVRecord::GetNewOffset(const StringView8CI &filePath) const
+{
+  for (const auto &sharedFileData : sharedData)
+  {
+    if (sharedFileData.path == filePath)
+      return sharedFileData.newOffset;
+  }
+
+  return newOffset;
+}
+
 bool Hitman4WAVFile::Clear(const bool retVal)
 {
   header = nullptr;
@@ -478,11 +791,11 @@ bool Hitman4WAVFile::Load(const std::vector<char> &wavData, const OrderedMap<Str
   {
     WHD::v2::EntryScenes *record = nullptr;
     Glacier1AudioFile& file;
+    std::vector<Glacier1AudioFile *> sharedFiles;
   };
 
-  auto resampledOffset = static_cast<uint32_t>(wavData.size());
-  size_t foundItems = 0;
-  OrderedMap<uint32_t, uint32_t> resampledMap;
+  // NOTE - records of different files may point to same data, it stays stored only once
+  std::vector<Glacier1AudioFile *> loadedFiles;
   OrderedMap<uint32_t, WAVFileData> offsetToWAVFileDataMap;
   for (auto& [whdRecordPath, whdRecord] : whdRecordsMap)
   {
@@ -492,21 +805,20 @@ bool Hitman4WAVFile::Load(const std::vector<char> &wavData, const OrderedMap<Str
       continue;
     }
 
-    auto offsetToWAVFileDataIt = offsetToWAVFileDataMap.find(whdRecord->dataOffset);
-    if (offsetToWAVFileDataIt != offsetToWAVFileDataMap.end())
-    {
-      resampledMap[resampledOffset] = whdRecord->dataOffset;
-      whdRecord->dataOffset = resampledOffset;
-      resampledOffset += whdRecord->dataSize;
-    }
+    auto& file = fileMap.at(whdRecordPath);
+    if (whdRecord->dataOffset + static_cast<uint64_t>(whdRecord->dataSize) > wavData.size())
+      return Clear(false);
 
-    offsetToWAVFileDataMap.insert({whdRecord->dataOffset, {whdRecord, fileMap.at(whdRecordPath)}});
+    const auto [offsetToWAVFileDataIt, offsetToWAVFileDataEmplaced] = offsetToWAVFileDataMap.try_emplace(whdRecord->dataOffset, WAVFileData{whdRecord, file});
+    if (!offsetToWAVFileDataEmplaced)
+      offsetToWAVFileDataIt->second.sharedFiles.emplace_back(&file);
 
-    ++foundItems;
-  }
+    file.data.resize(whdRecord->dataSize, 0);
+    file.data.shrink_to_fit();
+    std::memcpy(file.data.data(), wavData.data() + whdRecord->dataOffset, whdRecord->dataSize);
 
-  if (offsetToWAVFileDataMap.size() != foundItems)
-    return Clear(false);
+    loadedFiles.emplace_back(&file);
+  }
 
   recordMap.clear();
 
@@ -540,15 +852,11 @@ bool Hitman4WAVFile::Load(const std::vector<char> &wavData, const OrderedMap<Str
     }
     assert(currOffset <= offset);
 
-    auto& newData = wavFileData.file.data;
-    newData.resize(wavFileData.record->dataSize, 0);
-    newData.shrink_to_fit();
-
-    auto trueOffset = offset >= wavData.size() ? resampledMap[offset] : offset;
+    auto& record = recordMap.try_emplace(offset, Hitman4WAVRecord{wavFileData.file.data, offset, std::nullopt, &wavFileData.file.archiveRecord}).first->second;
+    for (auto *sharedFile : wavFileData.sharedFiles)
+      record.sharedData.emplace_back(Glacier1SharedAudioData{sharedFile->path, sharedFile->data, sharedFile->archiveRecord});
 
-    std::memcpy(newData.data(), wavData.data() + trueOffset, wavFileData.record->dataSize);
-    currOffset = offset + wavFileData.record->dataSize;
-    recordMap.try_emplace(offset, Hitman4WAVRecord{newData, offset});
+    currOffset = std::max(currOffset, offset + wavFileData.record->dataSize);
   }
 
   if (currOffset < wavData.size())
@@ -561,16 +869,14 @@ bool Hitman4WAVFile::Load(const std::vector<char> &wavData, const OrderedMap<Str
     recordMap.try_emplace(currOffset, Hitman4WAVRecord{newData, currOffset});
   }
 
-  const auto wavFileDataView = offsetToWAVFileDataMap | ranges::views::values;
-
   std::atomic_bool importFailed = false;
-  std::for_each(std::execution::par, wavFileDataView.begin(), wavFileDataView.end(), [this, &importFailed](auto& wavFileData)
+  std::for_each(std::execution::par, loadedFiles.begin(), loadedFiles.end(), [this, &importFailed](auto* loadedFile)
   {
     if (importFailed.load(std::memory_order_relaxed))
       return;
 
-    auto& glacier1AudioFile = wavFileData.file;
-    glacier1AudioFile.archiveRecord = SoundDataSoundRecord(glacier1AudioFile.archiveRecord, glacier1AudioFile.data);
+    auto& glacier1AudioFile = *loadedFile;
+    glacier1AudioFile.archiveRecord = HashedSoundRecord(glacier1AudioFile.archiveRecord, glacier1AudioFile.data);
     importFailed.store(importFailed.load(std::memory_order_relaxed) || glacier1AudioFile.archiveRecord.dataXXH3 == 0);
   });
 
@@ -591,7 +897,28 @@ bool Hitman4WAVFile::Load(const StringView8CI &loadPath, const OrderedMap<String
   return true;
 }
 
-bool Hitman4WAVFile::Save(const StringView8CI &savePathView)
+void Hitman4WAVFile::Layout()
+{
+  uint32_t offset = 0;
+  for (auto &record : recordMap | ranges::views::values)
+  {
+    record.newOffset = offset;
+    offset += static_cast<uint32_t>(record.data.size());
+
+    // NOTE - shared data is saved separately only once it differs from data of the owner
+    for (auto &sharedFileData : record.sharedData)
+    {
+      sharedFileData.newOffset = record.newOffset;
+      if (record.archiveRecord == nullptr || sharedFileData.archiveRecord.dataXXH3 == record.archiveRecord->dataXXH3)
+        continue;
+
+      sharedFileData.newOffset = offset;
+      offset += static_cast<uint32_t>(sharedFileData.data.size());
+    }
+  }
+}
+
+bool Hitman4WAVFile::Write(const StringView8CI &savePathView)
 {
   const auto savePath = savePathView.path();
   create_directories(savePath.parent_path());
@@ -599,29 +926,72 @@ bool Hitman4WAVFile::Save(const StringView8CI &savePathView)
   const auto oldSync = std::ios_base::sync_with_stdio(false);
 
   std::ofstream wavData(savePath, std::ios::binary | std::ios::trunc);
-
-  uint32_t offset = 0;
-  for (auto &record : recordMap | ranges::views::values)
+  if (!wavData)
   {
-    record.newOffset = offset;
-    offset += static_cast<uint32_t>(record.data.size());
+    std::ios_base::sync_with_stdio(oldSync);
+    return false;
   }
 
   for (auto &record : recordMap | ranges::views::values)
+  {
     wavData.write(record.data.data(), record.data.size());
 
+    for (const auto &sharedFileData : record.sharedData)
+    {
+      if (sharedFileData.newOffset != record.newOffset)
+        wavData.write(sharedFileData.data.data(), sharedFileData.data.size());
+    }
+  }
+
+  wavData.close();
+
   std::ios_base::sync_with_stdio(oldSync);
 
+  if (!wavData)
+    return false;
+
   path = savePath;
 
   return true;
 }
 
+void Hitman4WAVFile::CommitLayout()
+{
+  OrderedMap<uint32_t, Hitman4WAVRecord> newRecordMap;
+  for (const auto &record : recordMap | ranges::views::values)
+  {
+    auto &newRecord = newRecordMap.try_emplace(record.newOffset, Hitman4WAVRecord{record.data, record.newOffset, record.lipData, record.archiveRecord}).first->second;
+
+    // NOTE - shared data saved separately becomes record of its own
+    for (const auto &sharedFileData : record.sharedData)
+    {
+      if (sharedFileData.newOffset == record.newOffset)
+        newRecord.sharedData.emplace_back(sharedFileData);
+      else
+        newRecordMap.try_emplace(sharedFileData.newOffset, Hitman4WAVRecord{sharedFileData.data, sharedFileData.newOffset, std::nullopt, &sharedFileData.archiveRecord});
+    }
+  }
+
+  recordMap = std::move(newRecordMap);
+}
+
+bool Hitman4WAVFile::Save(const StringView8CI &savePathView)
+{
+  Layout();
+  if (!Write(savePathView))
+    return false;
+
+  CommitLayout();
+  return true;
+}
+
 bool Hitman4WHDFile::Clear(const bool retVal)
 {
   header = nullptr;
   recordMap.clear();
+  streamsRecords.clear();
   data.clear();
+  dataXXH3 = 0;
   path.clear();
 
   return retVal;
@@ -636,6 +1006,7 @@ bool Hitman4WHDFile::Load(Hitman4ArchiveDialog& archiveDialog, const StringView8
     return Clear(false);
 
   recordMap.clear();
+  streamsRecords.clear();
 
   auto *whdPtr = data.data();
   header = reinterpret_cast<WHD::v2::Header *>(whdPtr);
@@ -669,6 +1040,27 @@ bool Hitman4WHDFile::Load(Hitman4ArchiveDialog& archiveDialog, const StringView8
 
     if (whdRecord->dataInStreams)
     {
+      // NOTE - all kinds of entries share the same layout up to data offset, so streams entries are patched through scenes entry too
+      const auto addStreamsRecord = [this, &archiveDialog](WHD::v2::EntryScenes *streamsRecord, const uint64_t recordKey)
+      {
+        streamsRecords.emplace_back(streamsRecord);
+
+        const auto recordPathIt = archiveDialog.streamsWAV.recordPaths.find(recordKey);
+        if (recordPathIt == archiveDialog.streamsWAV.recordPaths.end())
+          return;
+
+        archiveDialog.whdStreamsRecordsMap[recordPathIt->second].emplace_back(streamsRecord);
+        archiveDialog.whdStreamsPatchedRecords.try_emplace(recordPathIt->second, archiveDialog.fileMap.at(recordPathIt->second).archiveRecord);
+      };
+
+      if (whdRecord->fileNameLength)
+        addStreamsRecord(whdRecord, whdRecord->dataOffset);
+      else
+      {
+        addStreamsRecord(whdRecord, whdRecord->dataOffset | 1);
+        addStreamsRecord(reinterpret_cast<WHD::v2::EntryScenes *>(whdPtr + whdStreamsSubRecordSize), whdRecord->dataOffset | 2);
+      }
+
       whdPtr += whdRecord->fileNameLength ? sizeof(WHD::v2::EntryStreams) : sizeof(WHD::v2::EntryStreamsDistanceBasedMaster);
       assert(static_cast<size_t>(whdPtr - data.data()) <= data.size());
       continue;
@@ -696,14 +1088,53 @@ bool Hitman4WHDFile::Load(Hitman4ArchiveDialog& archiveDialog, const StringView8
       return Clear(false);
   }
 
+  dataXXH3 = XXH3_64bits(data.data(), data.size());
   path = loadPathView;
 
   return true;
 }
 
-bool Hitman4WHDFile::Save(const Hitman4STRFile &streamsWAV, const Hitman4WAVFile &missionWAV, const StringView8CI &savePathView)
+bool Hitman4WHDFile::Save(const Hitman4STRFile &streamsWAV, const Hitman4WAVFile &missionWAV, const StringView8CI &savePath)
 {
-  return false;
+  for (const auto &[filePath, whdRecord] : recordMap)
+  {
+    const auto wavRecordIt = missionWAV.recordMap.find(whdRecord->dataOffset);
+    assert(wavRecordIt != missionWAV.recordMap.end());
+    if (wavRecordIt != missionWAV.recordMap.end())
+      whdRecord->dataOffset = wavRecordIt->second.GetNewOffset(filePath);
+  }
+
+  for (auto *whdRecord : streamsRecords)
+  {
+    const auto dataOffsetIt = streamsWAV.savedDataOffsets.find(whdRecord->dataOffset);
+    assert(dataOffsetIt != streamsWAV.savedDataOffsets.end());
+    if (dataOffsetIt != streamsWAV.savedDataOffsets.end())
+      whdRecord->dataOffset = static_cast<uint32_t>(dataOffsetIt->second);
+  }
+
+  // NOTE - scenes which were not touched are not written again
+  const auto newDataXXH3 = XXH3_64bits(data.data(), data.size());
+  if (newDataXXH3 == dataXXH3 && CopyUnchangedFile(path, savePath))
+  {
+    path = savePath;
+    return true;
+  }
+
+  const auto oldSync = std::ios_base::sync_with_stdio(false);
+
+  std::ofstream whdData(savePath.path(), std::ios::binary | std::ios::trunc);
+  whdData.write(data.data(), data.size());
+  whdData.close();
+
+  std::ios_base::sync_with_stdio(oldSync);
+
+  if (!whdData)
+    return false;
+
+  dataXXH3 = newDataXXH3;
+  path = savePath;
+
+  return true;
 }
 
 bool Hitman4ArchiveDialog::Clear(const bool retVal)
@@ -714,6 +1145,8 @@ bool Hitman4ArchiveDialog::Clear(const bool retVal)
   basePath.clear();
   fileMap.clear();
   whdRecordsMap.clear();
+  whdStreamsRecordsMap.clear();
+  whdStreamsPatchedRecords.clear();
 
   return Glacier1ArchiveDialog::Clear(retVal);
 }
@@ -727,20 +1160,17 @@ bool Hitman4ArchiveDialog::ExportSingle(const StringView8CI &exportFolderPath, c
   if (!options.hitman4.exportWithLIPData)
     return true;
 
-  const auto streamsFileNameIt = ranges::find_if(streamsWAV.stringTable, [fileName = exportFilePath.native().substr(8)](const auto& elem){ return fileName == elem; });
-  if (streamsFileNameIt == streamsWAV.stringTable.end())
+  const auto streamsIndexIt = streamsWAV.fileNameToIndex.find(StringView8CI(exportFilePath.native().substr(8)));
+  if (streamsIndexIt == streamsWAV.fileNameToIndex.end())
     return true;
 
-  const auto streamsIndex = std::distance(streamsWAV.stringTable.begin(), streamsFileNameIt);
-
-  const auto& lipData = streamsWAV.lipDataTable[streamsIndex];
+  const auto& lipData = streamsWAV.GetLIPData(streamsIndexIt->second);
   if (lipData.empty())
     return true;
 
+  // NOTE - LIP data is written next to the exported audio, so its folder already exists
   const auto exportPath = (exportFolderPath.path() / exportFilePath.path()).replace_extension(L".LIP");
 
-  create_directories(exportPath.parent_path());
-
   const auto oldSync = std::ios_base::sync_with_stdio(false);
 
   std::ofstream exportBin(exportPath, std::ios::binary | std::ios::trunc);
@@ -753,15 +1183,14 @@ bool Hitman4ArchiveDialog::ExportSingle(const StringView8CI &exportFolderPath, c
 
 bool Hitman4ArchiveDialog::ImportSingle(const StringView8CI &importFolderPath, const StringView8CI &importFilePath, const Options &options)
 {
+  // NOTE - streams entries which no scene refers to have no WHD records, they are still imported into streams
   auto filePath = relative(importFilePath.path(), importFolderPath.path());
   auto fileIt = fileMap.find(filePath);
-  auto whdRecordsIt = whdRecordsMap.find(filePath);
-  if (fileIt == fileMap.end() || whdRecordsIt == whdRecordsMap.end())
+  if (fileIt == fileMap.end())
   {
     filePath.replace_extension(filePath.extension() == StringViewWCI(L".wav") ? L".ogg" : L".wav");
     fileIt = fileMap.find(filePath);
-    whdRecordsIt = whdRecordsMap.find(filePath);
-    if (fileIt == fileMap.end() || whdRecordsIt == whdRecordsMap.end())
+    if (fileIt == fileMap.end())
     {
       DisplayWarning(g_LocalizationManager.LocalizeFormat("HITMAN_DIALOG_WARNING_MISSING_FILE", importFilePath),
                      g_LocalizationManager.Localize("MESSAGEBOX_TITLE_WARNING"), false, options);
@@ -769,13 +1198,95 @@ bool Hitman4ArchiveDialog::ImportSingle(const StringView8CI &importFolderPath, c
     }
   }
 
-  if (!ImportSingleHitmanFile(fileIt->second, importFilePath, options))
-    return false;
+  const auto *aliasedDataHeader = streamsWAV.GetAliasedDataHeader(fileIt->first);
+  if (!aliasedDataHeader)
+  {
+    if (!ImportSingleHitmanFile(fileIt->second, importFilePath, options))
+      return false;
 
-  for (auto* whdRecord : whdRecordsIt->second)
-    whdRecord->FromBaseDataInfo(fileIt->second.archiveRecord);
+    UpdateArchiveRecords(fileIt->second);
 
-  return true;
+    return true;
+  }
+
+  // NOTE - sub-records of aliased entries are interleaved back into their master as PCM S16 with the sample rate and
+  //        number of channels they were loaded with, so imports into them are always converted to that format
+  auto &glacier1AudioFile = fileIt->second;
+  const auto aliasedRecord = aliasedDataHeader->ToBaseDataInfo();
+  if (glacier1AudioFile.originalRecord.dataXXH3 == 0)
+    glacier1AudioFile.originalRecord = glacier1AudioFile.archiveRecord;
+
+  auto aliasedOptions = options;
+  aliasedOptions.common.directImport = false;
+  aliasedOptions.common.fixChannels = true;
+  aliasedOptions.common.fixSampleRate = true;
+
+  auto &archiveFile = GetFile(glacier1AudioFile.path);
+  const auto previousArchiveFile = archiveFile;
+  auto previousFile = glacier1AudioFile;
+  const auto imported = ImportSingleHitmanFile(glacier1AudioFile, importFilePath, aliasedOptions);
+
+  const auto &importedRecord = glacier1AudioFile.archiveRecord;
+  const auto importedFormat = glacier1AudioFile.pendingImport
+    ? glacier1AudioFile.pendingImport->targetFormat
+    : TranscodeFormat{importedRecord.format, importedRecord.sampleRate, importedRecord.channels};
+  if (imported && importedFormat.format == AudioDataFormat::PCM_S16 && importedFormat.sampleRate == aliasedRecord.sampleRate
+      && importedFormat.channels == aliasedRecord.channels)
+  {
+    UpdateArchiveRecords(glacier1AudioFile);
+
+    return true;
+  }
+
+  glacier1AudioFile = std::move(previousFile);
+  archiveFile = previousArchiveFile;
+
+  if (imported)
+  {
+    DisplayWarning(g_LocalizationManager.LocalizeFormat("HITMAN_4_DIALOG_WARNING_ALIASED_FORMAT", importFilePath),
+                   g_LocalizationManager.Localize("MESSAGEBOX_TITLE_WARNING"), false, options);
+  }
+
+  return false;
+}
+
+void Hitman4ArchiveDialog::UpdateArchiveRecords(const Glacier1AudioFile &glacier1AudioFile)
+{
+  const auto whdRecordsIt = whdRecordsMap.find(glacier1AudioFile.path);
+  if (whdRecordsIt != whdRecordsMap.end())
+  {
+    for (auto* whdRecord : whdRecordsIt->second)
+      whdRecord->FromBaseDataInfo(glacier1AudioFile.archiveRecord);
+  }
+
+  const auto whdStreamsRecordsIt = whdStreamsRecordsMap.find(glacier1AudioFile.path);
+  if (whdStreamsRecordsIt == whdStreamsRecordsMap.end())
+    return;
+
+  // NOTE - streams entries are patched through scenes entry layout, but fields the library derives from the record may
+  //        hold filler in them (samples per block of PCM S16 entries is 0xCDCDCDCD). Only words which differ between the
+  //        entry built from the record it was last patched from and from the new one are written, rest stays as it was.
+  auto &whdStreamsRecord = whdStreamsPatchedRecords.at(glacier1AudioFile.path);
+  static constexpr auto whdStreamsPatchedSize = std::min(sizeof(WHD::v2::EntryScenes), whdStreamsSubRecordSize);
+  for (auto* whdRecord : whdStreamsRecordsIt->second)
+  {
+    auto patchedRecord = *whdRecord;
+    patchedRecord.FromBaseDataInfo(whdStreamsRecord);
+
+    auto importedRecord = *whdRecord;
+    importedRecord.FromBaseDataInfo(glacier1AudioFile.archiveRecord);
+
+    auto *whdBytes = reinterpret_cast<char *>(whdRecord);
+    const auto *patchedBytes = reinterpret_cast<const char *>(&patchedRecord);
+    const auto *importedBytes = reinterpret_cast<const char *>(&importedRecord);
+    for (size_t offset = 0; offset < whdStreamsPatchedSize; offset += sizeof(uint32_t))
+    {
+      if (std::memcmp(patchedBytes + offset, importedBytes + offset, sizeof(uint32_t)) != 0)
+        std::memcpy(whdBytes + offset, importedBytes + offset, sizeof(uint32_t));
+    }
+  }
+
+  whdStreamsRecord = glacier1AudioFile.archiveRecord;
 }
 
 bool Hitman4ArchiveDialog::LoadImpl(const StringView8CI &loadPath, const Options &options)
@@ -832,12 +1343,31 @@ bool Hitman4ArchiveDialog::SaveImpl(const StringView8CI &savePathView, const Opt
 {
   const auto newBasePath = savePathView.path().parent_path();
 
-  streamsWAV.Save(savePathView);
+  // NOTE - scenes only need saved data offsets of streams, so streams are written alongside them
+  streamsWAV.Layout();
 
-  for (size_t i = 0; i < whdFiles.size(); ++i)
+  // NOTE - layout of scene WAV is committed only once its WHD file was written, failed ones keep their records keyed as they were
+  const auto saved = RunSaveJobs(whdFiles.size() + 1, [this, &savePathView, &newBasePath](const size_t saveJobIndex)
   {
-    wavFiles[i].Save(String8CI(newBasePath / relative(wavFiles[i].path.path(), basePath.path())));
-    whdFiles[i].Save(streamsWAV, wavFiles[i], String8CI(newBasePath / relative(whdFiles[i].path.path(), basePath.path())));
+    if (saveJobIndex == 0)
+      return streamsWAV.Write(savePathView);
+
+    const auto sceneIndex = saveJobIndex - 1;
+    wavFiles[sceneIndex].Layout();
+    if (!wavFiles[sceneIndex].Write(String8CI(newBasePath / relative(wavFiles[sceneIndex].path.path(), basePath.path()))))
+      return false;
+
+    if (!whdFiles[sceneIndex].Save(streamsWAV, wavFiles[sceneIndex], String8CI(newBasePath / relative(whdFiles[sceneIndex].path.path(), basePath.path()))))
+      return false;
+
+    wavFiles[sceneIndex].CommitLayout();
+    return true;
+  });
+
+  if (!saved)
+  {
+    DisplayError(g_LocalizationManager.Localize("ARCHIVE_DIALOG_SAVE_ERROR_WRITING_FILES"));
+    return false;
   }
 
   basePath = newBasePath;
@@ -862,7 +1392,7 @@ int32_t Hitman4ArchiveDialog::DrawDialog()
 
 bool Hitman4ArchiveDialog::IsSaveAllowed() const
 {
-  return G1AT_DEBUG_BUILD == 1;
+  return true;
 }
 
 bool Hitman4ArchiveDialog::IsExportAllowed() const
@@ -872,7 +1402,7 @@ bool Hitman4ArchiveDialog::IsExportAllowed() const
 
 bool Hitman4ArchiveDialog::IsImportAllowed() const
 {
-  return G1AT_DEBUG_BUILD == 1;
+  return true;
 }
 
 const std::vector<std::pair<StringView8CI, StringView8>>& Hitman4ArchiveDialog::GetOpenFilter()
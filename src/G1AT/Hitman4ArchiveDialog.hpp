@@ -11,12 +11,17 @@
 class Hitman4ArchiveDialog;
 
 inline constexpr std::array<uint32_t, 4> terminateBytes{0, 0, 0, 0};
+inline constexpr size_t whdStreamsSubRecordSize = 0x38; // size of single sub-record of WHD::v2::EntryStreamsDistanceBasedMaster
 
 struct Hitman4WAVRecord
 {
   std::vector<char>& data;
   uint32_t newOffset = 0;
   OptionalReference<std::vector<char>> lipData = std::nullopt;
+  const Glacier1AudioRecord *archiveRecord = nullptr; // record of the file owning the data, set only for scenes
+  std::vector<Glacier1SharedAudioData> sharedData; // other files stored in the same data
+
+  uint32_t GetNewOffset(const StringView8CI &filePath) const;
 };
 
 struct Hitman4STRFile
@@ -26,19 +31,37 @@ struct Hitman4STRFile
   bool Load(Hitman4ArchiveDialog& archiveDialog, const std::vector<char> &wavData);
   bool Load(Hitman4ArchiveDialog& archiveDialog, const StringView8CI &loadPath);
 
+  // Computes savedDataOffsets without writing anything, so WHD files may be patched before the data is written.
+  void Layout();
+  bool Write(const StringView8CI &savePath);
   bool Save(const StringView8CI &savePath);
 
+  // Entry indices grouped by data offset, in order of data in the file. Aliased entries form single group.
+  OrderedMap<uint64_t, std::vector<uint32_t>> GetDataOffsetEntries() const;
+
+  // LIP data of the entry, empty when it has none. Sub-records of aliased entries share LIP data of their master.
+  const std::vector<char> &GetLIPData(size_t index) const;
+
+  // WAV header the aliased sub-record holding the file was loaded with, nullptr when the file is not stored in one.
+  const STR::v1::DataHeader *GetAliasedDataHeader(const StringView8CI &filePath) const;
+
   OrderedMap<uint64_t, Hitman4WAVRecord> recordMap;
+  OrderedMap<uint64_t, StringView8CI> recordPaths; // paths of files keyed same as recordMap
   std::list<std::vector<char>> extraData;
 
   STR::v1::Header                  header;
   std::vector<std::vector<char>>   wavDataTable;
   std::vector<std::vector<char>>   lipDataTable;
+  std::vector<uint32_t>            lipDataIndexTable; // index into lipDataTable which holds LIP data of the entry
+  std::vector<uint64_t>            lipSegmentSizeTable; // 0 when there is single LIP segment or none
   std::vector<STR::v1::DataHeader> wavHeaderTable;
   std::vector<String8CI>           stringTable;
   std::vector<STR::v1::Entry>      recordTable;
+  std::vector<const Glacier1AudioRecord *> archiveRecordTable; // record of the file of the entry, nullptr for aliased masters
+  std::vector<Glacier1AudioRecord> savedRecordTable; // records as they were last loaded or saved, WAV headers are rebuilt when they differ
 
   OrderedMap<StringView8CI, size_t> fileNameToIndex;
+  OrderedMap<uint64_t, uint64_t> savedDataOffsets; // data offsets before last save mapped to saved ones
 
   //uint64_t wavDataTableBeginOffset = 0; // == header.dataBeginOffset
   uint64_t wavHeaderTableBeginOffset = 0;
@@ -57,6 +80,11 @@ struct Hitman4WAVFile
   bool Load(const StringView8CI &loadPath, const OrderedMap<StringView8CI, WHD::v2::EntryScenes *> &whdRecordsMap,
             OrderedMap<StringView8CI, Glacier1AudioFile>& fileMap);
 
+  // Assigns new offsets to records, so WHD files may be patched before the data is written.
+  void Layout();
+  bool Write(const StringView8CI &savePath);
+  // Rekeys records by their new offsets, once WHD file referencing them was saved.
+  void CommitLayout();
   bool Save(const StringView8CI &savePath);
 
   WAV::v2::Header *header = nullptr;
@@ -75,7 +103,9 @@ struct Hitman4WHDFile
 
   WHD::v2::Header *header = nullptr;
   OrderedMap<StringView8CI, WHD::v2::EntryScenes *> recordMap;
+  std::vector<WHD::v2::EntryScenes *> streamsRecords; // each sub-record of aliased entries is listed separately
   std::vector<char> data;
+  uint64_t dataXXH3 = 0; // hash of data as it was last loaded or saved
   String8CI path;
 };
 
@@ -88,6 +118,8 @@ public:
 
   bool ImportSingle(const StringView8CI &importFolderPath, const StringView8CI &importFilePath, const Options &options) override;
 
+  void UpdateArchiveRecords(const Glacier1AudioFile &glacier1AudioFile) override;
+
   bool LoadImpl(const StringView8CI &loadPath, const Options &options) override;
 
   bool SaveImpl(const StringView8CI &savePath, const Options &options) override;
@@ -107,6 +139,8 @@ public:
   Hitman4STRFile streamsWAV;
 
   OrderedMap<StringView8CI, std::vector<WHD::v2::EntryScenes *>> whdRecordsMap;
+  OrderedMap<StringView8CI, std::vector<WHD::v2::EntryScenes *>> whdStreamsRecordsMap; // streams entries of all scenes referring to the file
+  OrderedMap<StringView8CI, Glacier1AudioRecord> whdStreamsPatchedRecords; // record streams entries of the file were last patched from
 
   String8CI basePath;
 };
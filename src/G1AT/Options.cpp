@@ -23,6 +23,10 @@ void CommonSettings::Load(const toml::table &aInputRoot)
   directImport = commonTable["direct_import"].value_or(directImport);
   transcodeToPlayableFormat = commonTable["transcode_to_playable_format"].value_or(transcodeToPlayableFormat);
   transcodeOGGToPCM = commonTable["transcode_ogg_to_pcm"].value_or(transcodeOGGToPCM);
+  resamplerQuality = static_cast<ResamplerQuality>(std::clamp(commonTable["resampler_quality"].value_or(static_cast<int32_t>(resamplerQuality)),
+                                                              static_cast<int32_t>(ResamplerQuality::FAST), static_cast<int32_t>(ResamplerQuality::HIGH)));
+  vorbisQuality = static_cast<VorbisQualityPreset>(std::clamp(commonTable["vorbis_quality"].value_or(static_cast<int32_t>(vorbisQuality)),
+                                                              static_cast<int32_t>(VorbisQualityPreset::LOW), static_cast<int32_t>(VorbisQualityPreset::HIGH)));
 
   g_LocalizationManager.SetLanguage(commonTable["language"].value_or(g_LocalizationManager.GetLanguage().native()));
 }
@@ -39,6 +43,8 @@ void CommonSettings::Save(toml::table &aOutputRoot) const
   commonTable.emplace("direct_import", directImport);
   commonTable.emplace("transcode_to_playable_format", transcodeToPlayableFormat);
   commonTable.emplace("transcode_ogg_to_pcm", transcodeOGGToPCM);
+  commonTable.emplace("resampler_quality", static_cast<int32_t>(resamplerQuality));
+  commonTable.emplace("vorbis_quality", static_cast<int32_t>(vorbisQuality));
 
   commonTable.emplace("language", g_LocalizationManager.GetLanguage().native());
 
@@ -108,6 +114,71 @@ void CommonSettings::DrawDialog()
 
   ImGui::TreePop();
 
+  const std::array resamplerQualityNames{
+    g_LocalizationManager.Localize("SETTINGS_DIALOG_RESAMPLER_QUALITY_FAST"),
+    g_LocalizationManager.Localize("SETTINGS_DIALOG_RESAMPLER_QUALITY_BALANCED"),
+    g_LocalizationManager.Localize("SETTINGS_DIALOG_RESAMPLER_QUALITY_HIGH")
+  };
+  if (ImGui::BeginCombo(g_LocalizationManager.Localize("SETTINGS_DIALOG_RESAMPLER_QUALITY").c_str(), resamplerQualityNames[static_cast<size_t>(resamplerQuality)].c_str()))
+  {
+    for (size_t quality = 0; quality < resamplerQualityNames.size(); ++quality)
+    {
+      bool selected = static_cast<size_t>(resamplerQuality) == quality;
+      if (ImGui::Selectable(resamplerQualityNames[quality].c_str(), &selected))
+        resamplerQuality = static_cast<ResamplerQuality>(quality);
+    }
+    ImGui::EndCombo();
+  }
+
+  const std::array vorbisQualityNames{
+    g_LocalizationManager.Localize("SETTINGS_DIALOG_VORBIS_QUALITY_LOW"),
+    g_LocalizationManager.Localize("SETTINGS_DIALOG_VORBIS_QUALITY_MEDIUM"),
+    g_LocalizationManager.Localize("SETTINGS_DIALOG_VORBIS_QUALITY_HIGH")
+  };
+  if (ImGui::BeginCombo(g_LocalizationManager.Localize("SETTINGS_DIALOG_VORBIS_QUALITY").c_str(), vorbisQualityNames[static_cast<size_t>(vorbisQuality)].c_str()))
+  {
+    for (size_t quality = 0; quality < vorbisQualityNames.size(); ++quality)
+    {
+      bool selected = static_cast<size_t>(vorbisQuality) == quality;
+      if (ImGui::Selectable(vorbisQualityNames[quality].c_str(), &selected))
+        vorbisQuality = static_cast<VorbisQualityPreset>(quality);
+    }
+    ImGui::EndCombo();
+  }
+
+  ImGui::EndTabItem();
+}
+
+void Hitman23Settings::Load(const toml::table &aInputRoot)
+{
+  ResetToDefaults();
+
+  const auto& hitman23Table = aInputRoot["hitman23"];
+
+  loadScenesOnDemand = hitman23Table["load_scenes_on_demand"].value_or(loadScenesOnDemand);
+}
+
+void Hitman23Settings::Save(toml::table &aOutputRoot) const
+{
+  toml::table hitman23Table;
+
+  hitman23Table.emplace("load_scenes_on_demand", loadScenesOnDemand);
+
+  aOutputRoot.emplace("hitman23", std::move(hitman23Table));
+}
+
+void Hitman23Settings::ResetToDefaults()
+{
+  *this = {};
+}
+
+void Hitman23Settings::DrawDialog()
+{
+  if (!ImGui::BeginTabItem(g_LocalizationManager.Localize("SETTINGS_DIALOG_HITMAN23_GROUP").c_str()))
+    return;
+
+  ImGui::Checkbox(g_LocalizationManager.Localize("SETTINGS_DIALOG_HITMAN23_LOAD_SCENES_ON_DEMAND").c_str(), &loadScenesOnDemand);
+
   ImGui::EndTabItem();
 }
 
@@ -157,6 +228,7 @@ void Options::Load()
     return;
 
   common.Load(config);
+  hitman23.Load(config);
   hitman4.Load(config);
 }
 
@@ -171,6 +243,7 @@ void Options::Save() const
   toml::table config;
 
   common.Save(config);
+  hitman23.Save(config);
   hitman4.Save(config);
 
   std::ofstream(optionsPath, std::ios::trunc) << config;
@@ -179,6 +252,7 @@ void Options::Save() const
 void Options::ResetToDefaults()
 {
   common.ResetToDefaults();
+  hitman23.ResetToDefaults();
   hitman4.ResetToDefaults();
 
   Save();
@@ -197,6 +271,7 @@ void Options::DrawDialog()
   if (ImGui::BeginTabBar("##SettingCategoryTabs"))
   {
     common.DrawDialog();
+    hitman23.DrawDialog();
     hitman4.DrawDialog();
 
     ImGui::EndTabBar();
@@ -5,7 +5,9 @@
 
 #pragma once
 
+#include "Resampler.hpp"
 #include "Singleton.hpp"
+#include "Vorbis.hpp"
 
 class CommonSettings
 {
@@ -26,6 +28,22 @@ public:
   bool directImport{false};
   bool transcodeToPlayableFormat{true};
   bool transcodeOGGToPCM{false};
+  ResamplerQuality resamplerQuality{ResamplerQuality::BALANCED};
+  VorbisQualityPreset vorbisQuality{VorbisQualityPreset::MEDIUM};
+};
+
+class Hitman23Settings
+{
+public:
+  void Load(const toml::table &aInputRoot);
+  void Save(toml::table &aOutputRoot) const;
+  void ResetToDefaults();
+
+  void DrawDialog();
+
+  [[nodiscard]] auto operator<=>(const Hitman23Settings &) const = default;
+
+  bool loadScenesOnDemand{false};
 };
 
 class Hitman4Settings
@@ -56,6 +74,9 @@ public:
     if (const auto cmp = common <=> other.common; cmp != std::strong_ordering::equal)
       return cmp;
 
+    if (const auto cmp = hitman23 <=> other.hitman23; cmp != std::strong_ordering::equal)
+      return cmp;
+
     if (const auto cmp = hitman4 <=> other.hitman4; cmp != std::strong_ordering::equal)
       return cmp;
 
@@ -68,6 +89,7 @@ public:
   }
 
   CommonSettings common;
+  Hitman23Settings hitman23;
   Hitman4Settings hitman4;
   bool opened = false;
 };
@@ -0,0 +1,494 @@
+//
+// Created by Andrej Redeky.
+// Copyright © 2015-2023 Feldarian Softworks. All rights reserved.
+// SPDX-License-Identifier: EUPL-1.2
+//
+
+#include <Precompiled.hpp>
+
+#include "Remix.hpp"
+
+#include "SIMD.hpp"
+
+// NOTE - kernels are memory bound, 128-bit vectors saturate the bandwidth already, so there are no AVX2 variants
+
+namespace
+{
+
+int16_t SaturateSample(const float sample)
+{
+  return static_cast<int16_t>(std::clamp(std::lrint(sample), -32768l, 32767l));
+}
+
+bool UseSIMD()
+{
+  static const auto useSIMD = GetSIMDLevel() != SIMDLevel::SCALAR;
+  return useSIMD;
+}
+
+#if G1AT_SIMD_X86
+
+G1AT_TARGET_SSE41 size_t DownmixStereoToMonoSSE41(const int16_t *input, const size_t frames, int16_t *output)
+{
+  const auto one = _mm_set1_epi32(1);
+
+  size_t frame = 0;
+  for (; frame + 8 <= frames; frame += 8)
+  {
+    const auto lowFrames = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + frame * 2));
+    const auto highFrames = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + frame * 2 + 8));
+
+    const auto lowSum = _mm_add_epi32(_mm_add_epi32(_mm_srai_epi32(_mm_slli_epi32(lowFrames, 16), 16), _mm_srai_epi32(lowFrames, 16)), one);
+    const auto highSum = _mm_add_epi32(_mm_add_epi32(_mm_srai_epi32(_mm_slli_epi32(highFrames, 16), 16), _mm_srai_epi32(highFrames, 16)), one);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output + frame), _mm_packs_epi32(_mm_srai_epi32(lowSum, 1), _mm_srai_epi32(highSum, 1)));
+  }
+
+  return frame;
+}
+
+G1AT_TARGET_SSE41 size_t UpmixMonoToStereoSSE41(const int16_t *input, const size_t frames, int16_t *output)
+{
+  // NOTE - goes from the end, so in place upmix never overwrites samples which were not read yet
+  auto frame = frames / 8 * 8;
+  while (frame != 0)
+  {
+    frame -= 8;
+
+    const auto samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + frame));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output + frame * 2 + 8), _mm_unpackhi_epi16(samples, samples));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output + frame * 2), _mm_unpacklo_epi16(samples, samples));
+  }
+
+  return frames / 8 * 8;
+}
+
+G1AT_TARGET_SSE41 size_t DeinterleaveToFloatSSE41(const int16_t *input, const size_t frames, const uint16_t channels, float *const *outputs)
+{
+  size_t frame = 0;
+  if (channels == 1)
+  {
+    for (; frame + 4 <= frames; frame += 4)
+    {
+      const auto samples = _mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(input + frame)));
+      _mm_storeu_ps(outputs[0] + frame, _mm_cvtepi32_ps(samples));
+    }
+  }
+  else if (channels == 2)
+  {
+    for (; frame + 4 <= frames; frame += 4)
+    {
+      const auto samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + frame * 2));
+      _mm_storeu_ps(outputs[0] + frame, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(samples, 16), 16)));
+      _mm_storeu_ps(outputs[1] + frame, _mm_cvtepi32_ps(_mm_srai_epi32(samples, 16)));
+    }
+  }
+
+  return frame;
+}
+
+G1AT_TARGET_SSE41 size_t InterleaveFromFloatSSE41(const float *const *inputs, const size_t frames, const uint16_t channels, int16_t *output)
+{
+  size_t frame = 0;
+  if (channels == 1)
+  {
+    for (; frame + 8 <= frames; frame += 8)
+    {
+      const auto lowSamples = _mm_cvtps_epi32(_mm_loadu_ps(inputs[0] + frame));
+      const auto highSamples = _mm_cvtps_epi32(_mm_loadu_ps(inputs[0] + frame + 4));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(output + frame), _mm_packs_epi32(lowSamples, highSamples));
+    }
+  }
+  else if (channels == 2)
+  {
+    for (; frame + 4 <= frames; frame += 4)
+    {
+      const auto leftSamples = _mm_cvtps_epi32(_mm_loadu_ps(inputs[0] + frame));
+      const auto rightSamples = _mm_cvtps_epi32(_mm_loadu_ps(inputs[1] + frame));
+      const auto samples = _mm_packs_epi32(leftSamples, rightSamples);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(output + frame * 2), _mm_unpacklo_epi16(samples, _mm_srli_si128(samples, 8)));
+    }
+  }
+
+  return frame;
+}
+
+G1AT_TARGET_SSE41 size_t SplitInterleavedBlocksSSE41(const char *input, const size_t primaryBlockSamples, const size_t secondaryBlockSamples, char *primary,
+                                                     char *secondary, const size_t blocksCount)
+{
+  // NOTE - chunk of 48 samples holds whole number of block pairs and whole output registers for all common patterns
+  constexpr size_t chunkSamples = 48;
+  constexpr size_t chunkRegisters = chunkSamples / 8;
+
+  const auto pairSamples = primaryBlockSamples + secondaryBlockSamples;
+  if (primaryBlockSamples == 0 || secondaryBlockSamples == 0 || chunkSamples % pairSamples != 0)
+    return 0;
+
+  const auto chunkPairs = chunkSamples / pairSamples;
+  const auto primaryChunkSamples = chunkPairs * primaryBlockSamples;
+  if (primaryChunkSamples % 8 != 0)
+    return 0;
+
+  std::array<std::array<std::array<int8_t, 16>, chunkRegisters>, chunkRegisters> shuffles{};
+  for (auto &outputShuffles : shuffles)
+  {
+    for (auto &shuffle : outputShuffles)
+      shuffle.fill(-128);
+  }
+
+  std::array<std::pair<size_t, size_t>, chunkRegisters> inputRanges;
+  inputRanges.fill({chunkRegisters, 0});
+  for (size_t sample = 0; sample < chunkSamples; ++sample)
+  {
+    const auto pair = sample / pairSamples;
+    const auto pairSample = sample % pairSamples;
+    const auto outputSample = pairSample < primaryBlockSamples ? pair * primaryBlockSamples + pairSample
+                                                               : primaryChunkSamples + pair * secondaryBlockSamples + pairSample - primaryBlockSamples;
+
+    auto &shuffle = shuffles[outputSample / 8][sample / 8];
+    shuffle[(outputSample % 8) * 2] = static_cast<int8_t>((sample % 8) * 2);
+    shuffle[(outputSample % 8) * 2 + 1] = static_cast<int8_t>((sample % 8) * 2 + 1);
+
+    auto &inputRange = inputRanges[outputSample / 8];
+    inputRange.first = std::min(inputRange.first, sample / 8);
+    inputRange.second = std::max(inputRange.second, sample / 8);
+  }
+
+  const auto primaryRegisters = primaryChunkSamples / 8;
+  const auto chunksCount = blocksCount / chunkPairs;
+  for (size_t chunk = 0; chunk < chunksCount; ++chunk)
+  {
+    __m128i samples[chunkRegisters];
+    for (size_t i = 0; i < chunkRegisters; ++i)
+      samples[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + (chunk * chunkRegisters + i) * 16));
+
+    for (size_t output = 0; output < chunkRegisters; ++output)
+    {
+      auto result = _mm_setzero_si128();
+      for (auto i = inputRanges[output].first; i <= inputRanges[output].second; ++i)
+        result = _mm_or_si128(result, _mm_shuffle_epi8(samples[i], _mm_loadu_si128(reinterpret_cast<const __m128i *>(shuffles[output][i].data()))));
+
+      auto *outputData = output < primaryRegisters ? primary + (chunk * primaryRegisters + output) * 16
+                                                   : secondary + (chunk * (chunkRegisters - primaryRegisters) + output - primaryRegisters) * 16;
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(outputData), result);
+    }
+  }
+
+  return chunksCount * chunkPairs;
+}
+
+#elif G1AT_SIMD_NEON
+
+size_t DownmixStereoToMonoNEON(const int16_t *input, const size_t frames, int16_t *output)
+{
+  size_t frame = 0;
+  for (; frame + 8 <= frames; frame += 8)
+  {
+    const auto samples = vld2q_s16(input + frame * 2);
+    vst1q_s16(output + frame, vrhaddq_s16(samples.val[0], samples.val[1]));
+  }
+
+  return frame;
+}
+
+size_t UpmixMonoToStereoNEON(const int16_t *input, const size_t frames, int16_t *output)
+{
+  // NOTE - goes from the end, so in place upmix never overwrites samples which were not read yet
+  auto frame = frames / 8 * 8;
+  while (frame != 0)
+  {
+    frame -= 8;
+
+    const auto samples = vld1q_s16(input + frame);
+    vst2q_s16(output + frame * 2, int16x8x2_t{samples, samples});
+  }
+
+  return frames / 8 * 8;
+}
+
+size_t DeinterleaveToFloatNEON(const int16_t *input, const size_t frames, const uint16_t channels, float *const *outputs)
+{
+  size_t frame = 0;
+  if (channels == 1)
+  {
+    for (; frame + 8 <= frames; frame += 8)
+    {
+      const auto samples = vld1q_s16(input + frame);
+      vst1q_f32(outputs[0] + frame, vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))));
+      vst1q_f32(outputs[0] + frame + 4, vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))));
+    }
+  }
+  else if (channels == 2)
+  {
+    for (; frame + 8 <= frames; frame += 8)
+    {
+      const auto samples = vld2q_s16(input + frame * 2);
+      for (uint16_t channel = 0; channel < 2; ++channel)
+      {
+        vst1q_f32(outputs[channel] + frame, vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples.val[channel]))));
+        vst1q_f32(outputs[channel] + frame + 4, vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples.val[channel]))));
+      }
+    }
+  }
+
+  return frame;
+}
+
+size_t InterleaveFromFloatNEON(const float *const *inputs, const size_t frames, const uint16_t channels, int16_t *output)
+{
+  const auto saturate = [](const float *samples) {
+    return vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(vld1q_f32(samples))), vqmovn_s32(vcvtnq_s32_f32(vld1q_f32(samples + 4))));
+  };
+
+  size_t frame = 0;
+  if (channels == 1)
+  {
+    for (; frame + 8 <= frames; frame += 8)
+      vst1q_s16(output + frame, saturate(inputs[0] + frame));
+  }
+  else if (channels == 2)
+  {
+    for (; frame + 8 <= frames; frame += 8)
+      vst2q_s16(output + frame * 2, int16x8x2_t{saturate(inputs[0] + frame), saturate(inputs[1] + frame)});
+  }
+
+  return frame;
+}
+
+size_t SplitInterleavedBlocksNEON(const char *input, const size_t primaryBlockSamples, const size_t secondaryBlockSamples, char *primary, char *secondary,
+                                  const size_t blocksCount)
+{
+  auto *primarySamples = reinterpret_cast<uint16_t *>(primary);
+  auto *secondarySamples = reinterpret_cast<uint16_t *>(secondary);
+  const auto *inputSamples = reinterpret_cast<const uint16_t *>(input);
+
+  size_t block = 0;
+  if (primaryBlockSamples == 1 && secondaryBlockSamples == 1)
+  {
+    for (; block + 8 <= blocksCount; block += 8)
+    {
+      const auto samples = vld2q_u16(inputSamples + block * 2);
+      vst1q_u16(primarySamples + block, samples.val[0]);
+      vst1q_u16(secondarySamples + block, samples.val[1]);
+    }
+  }
+  else if (primaryBlockSamples == 2 && secondaryBlockSamples == 2)
+  {
+    for (; block + 4 <= blocksCount; block += 4)
+    {
+      const auto samples = vld2q_u32(reinterpret_cast<const uint32_t *>(inputSamples + block * 4));
+      vst1q_u32(reinterpret_cast<uint32_t *>(primarySamples + block * 2), samples.val[0]);
+      vst1q_u32(reinterpret_cast<uint32_t *>(secondarySamples + block * 2), samples.val[1]);
+    }
+  }
+  else if (primaryBlockSamples == 2 && secondaryBlockSamples == 1)
+  {
+    for (; block + 8 <= blocksCount; block += 8)
+    {
+      const auto samples = vld3q_u16(inputSamples + block * 3);
+      vst2q_u16(primarySamples + block * 2, uint16x8x2_t{samples.val[0], samples.val[1]});
+      vst1q_u16(secondarySamples + block, samples.val[2]);
+    }
+  }
+  else if (primaryBlockSamples == 1 && secondaryBlockSamples == 2)
+  {
+    for (; block + 8 <= blocksCount; block += 8)
+    {
+      const auto samples = vld3q_u16(inputSamples + block * 3);
+      vst1q_u16(primarySamples + block, samples.val[0]);
+      vst2q_u16(secondarySamples + block * 2, uint16x8x2_t{samples.val[1], samples.val[2]});
+    }
+  }
+
+  return block;
+}
+
+#endif
+
+}
+
+void PCMS16DownmixStereoToMono(const int16_t *input, const size_t frames, int16_t *output)
+{
+  size_t frame = 0;
+#if G1AT_SIMD_X86
+  if (UseSIMD())
+    frame = DownmixStereoToMonoSSE41(input, frames, output);
+#elif G1AT_SIMD_NEON
+  frame = DownmixStereoToMonoNEON(input, frames, output);
+#endif
+
+  for (; frame < frames; ++frame)
+    output[frame] = static_cast<int16_t>((input[frame * 2] + input[frame * 2 + 1] + 1) >> 1);
+}
+
+void PCMS16UpmixMonoToStereo(const int16_t *input, const size_t frames, int16_t *output)
+{
+  // NOTE - tail is handled first, it lies past all vectorized frames
+  for (auto frame = frames; frame-- > frames / 8 * 8;)
+  {
+    const auto sample = input[frame];
+    output[frame * 2] = sample;
+    output[frame * 2 + 1] = sample;
+  }
+
+  size_t frame = frames / 8 * 8;
+#if G1AT_SIMD_X86
+  if (UseSIMD())
+    frame -= UpmixMonoToStereoSSE41(input, frames, output);
+#elif G1AT_SIMD_NEON
+  frame -= UpmixMonoToStereoNEON(input, frames, output);
+#endif
+
+  while (frame != 0)
+  {
+    --frame;
+
+    const auto sample = input[frame];
+    output[frame * 2] = sample;
+    output[frame * 2 + 1] = sample;
+  }
+}
+
+void PCMS16RemixChannels(int16_t *frames, const size_t framesCount, const uint16_t inputChannels, const uint16_t outputChannels)
+{
+  if (inputChannels == outputChannels)
+    return;
+
+  if (inputChannels == 2 && outputChannels == 1)
+    return PCMS16DownmixStereoToMono(frames, framesCount, frames);
+
+  if (inputChannels == 1 && outputChannels == 2)
+    return PCMS16UpmixMonoToStereo(frames, framesCount, frames);
+
+  const auto remixFrame = [&](const size_t frame) {
+    std::array<int16_t, 256> inputFrame{};
+    std::copy_n(frames + frame * inputChannels, std::min<size_t>(inputChannels, inputFrame.size()), inputFrame.begin());
+
+    auto *outputFrame = frames + frame * outputChannels;
+    if (outputChannels == 1)
+    {
+      int32_t sum = 0;
+      for (uint16_t channel = 0; channel < inputChannels; ++channel)
+        sum += inputFrame[channel];
+
+      outputFrame[0] = static_cast<int16_t>((sum + inputChannels / 2) / inputChannels);
+    }
+    else if (inputChannels == 1)
+    {
+      for (uint16_t channel = 0; channel < outputChannels; ++channel)
+        outputFrame[channel] = inputFrame[0];
+    }
+    else
+    {
+      for (uint16_t channel = 0; channel < outputChannels; ++channel)
+        outputFrame[channel] = channel < inputChannels ? inputFrame[channel] : 0;
+    }
+  };
+
+  if (outputChannels < inputChannels)
+  {
+    for (size_t frame = 0; frame < framesCount; ++frame)
+      remixFrame(frame);
+  }
+  else
+  {
+    for (auto frame = framesCount; frame-- > 0;)
+      remixFrame(frame);
+  }
+}
+
+void PCMS16DeinterleaveToFloat(const int16_t *input, const size_t frames, const uint16_t channels, float *const *outputs)
+{
+  size_t frame = 0;
+#if G1AT_SIMD_X86
+  if (UseSIMD())
+    frame = DeinterleaveToFloatSSE41(input, frames, channels, outputs);
+#elif G1AT_SIMD_NEON
+  frame = DeinterleaveToFloatNEON(input, frames, channels, outputs);
+#endif
+
+  for (; frame < frames; ++frame)
+  {
+    for (uint16_t channel = 0; channel < channels; ++channel)
+      outputs[channel][frame] = static_cast<float>(input[frame * channels + channel]);
+  }
+}
+
+void PCMS16InterleaveFromFloat(const float *const *inputs, const size_t frames, const uint16_t channels, int16_t *output)
+{
+  size_t frame = 0;
+#if G1AT_SIMD_X86
+  if (UseSIMD())
+    frame = InterleaveFromFloatSSE41(inputs, frames, channels, output);
+#elif G1AT_SIMD_NEON
+  frame = InterleaveFromFloatNEON(inputs, frames, channels, output);
+#endif
+
+  for (; frame < frames; ++frame)
+  {
+    for (uint16_t channel = 0; channel < channels; ++channel)
+      output[frame * channels + channel] = SaturateSample(inputs[channel][frame]);
+  }
+}
+
+void PCMS16SplitInterleavedBlocks(const char *input, const size_t primaryBlockSize, const size_t secondaryBlockSize, char *primary, const size_t primarySize,
+                                  char *secondary, const size_t secondarySize)
+{
+  size_t primaryOffset = 0;
+  size_t secondaryOffset = 0;
+  if (primaryBlockSize != 0 && secondaryBlockSize != 0 && primaryBlockSize % sizeof(int16_t) == 0 && secondaryBlockSize % sizeof(int16_t) == 0)
+  {
+    const auto blocksCount = std::min(primarySize / primaryBlockSize, secondarySize / secondaryBlockSize);
+
+    size_t splitBlocks = 0;
+#if G1AT_SIMD_X86
+    if (UseSIMD())
+      splitBlocks = SplitInterleavedBlocksSSE41(input, primaryBlockSize / sizeof(int16_t), secondaryBlockSize / sizeof(int16_t), primary, secondary, blocksCount);
+#elif G1AT_SIMD_NEON
+    splitBlocks = SplitInterleavedBlocksNEON(input, primaryBlockSize / sizeof(int16_t), secondaryBlockSize / sizeof(int16_t), primary, secondary, blocksCount);
+#endif
+
+    primaryOffset = splitBlocks * primaryBlockSize;
+    secondaryOffset = splitBlocks * secondaryBlockSize;
+  }
+
+  auto inputOffset = primaryOffset + secondaryOffset;
+  while (primaryOffset < primarySize || secondaryOffset < secondarySize)
+  {
+    const auto primaryCopySize = std::min(primaryBlockSize, primarySize - primaryOffset);
+    std::memcpy(primary + primaryOffset, input + inputOffset, primaryCopySize);
+    primaryOffset += primaryCopySize;
+    inputOffset += primaryCopySize;
+
+    const auto secondaryCopySize = std::min(secondaryBlockSize, secondarySize - secondaryOffset);
+    std::memcpy(secondary + secondaryOffset, input + inputOffset, secondaryCopySize);
+    secondaryOffset += secondaryCopySize;
+    inputOffset += secondaryCopySize;
+
+    if (primaryCopySize == 0 && secondaryCopySize == 0)
+      break;
+  }
+}
+
+void PCMS16MergeInterleavedBlocks(const char *primary, const size_t primarySize, const char *secondary, const size_t secondarySize, const size_t primaryBlockSize,
+                                  const size_t secondaryBlockSize, char *output)
+{
+  size_t primaryOffset = 0;
+  size_t secondaryOffset = 0;
+  size_t outputOffset = 0;
+  while (primaryOffset < primarySize || secondaryOffset < secondarySize)
+  {
+    const auto primaryCopySize = std::min(primaryBlockSize, primarySize - primaryOffset);
+    std::memcpy(output + outputOffset, primary + primaryOffset, primaryCopySize);
+    primaryOffset += primaryCopySize;
+    outputOffset += primaryCopySize;
+
+    const auto secondaryCopySize = std::min(secondaryBlockSize, secondarySize - secondaryOffset);
+    std::memcpy(output + outputOffset, secondary + secondaryOffset, secondaryCopySize);
+    secondaryOffset += secondaryCopySize;
+    outputOffset += secondaryCopySize;
+
+    if (primaryCopySize == 0 && secondaryCopySize == 0)
+      break;
+  }
+}
@@ -0,0 +1,34 @@
+//
+// Created by Andrej Redeky.
+// Copyright © 2015-2023 Feldarian Softworks. All rights reserved.
+// SPDX-License-Identifier: EUPL-1.2
+//
+// Vectorized kernels for mono and stereo PCM S16 data. Mono and stereo cover every sound in Glacier 1 archives,
+// other channel counts go through scalar fallbacks.
+//
+
+#pragma once
+
+// Averages both channels, rounding half up. Output may be the same buffer as input.
+void PCMS16DownmixStereoToMono(const int16_t *input, size_t frames, int16_t *output);
+
+// Duplicates the channel. Output may be the same buffer as input, when it is large enough to hold stereo frames.
+void PCMS16UpmixMonoToStereo(const int16_t *input, size_t frames, int16_t *output);
+
+// Remixes frames in place, buffer must be large enough to hold frames in both channel counts.
+void PCMS16RemixChannels(int16_t *frames, size_t framesCount, uint16_t inputChannels, uint16_t outputChannels);
+
+// Converts interleaved frames into planar float channels.
+void PCMS16DeinterleaveToFloat(const int16_t *input, size_t frames, uint16_t channels, float *const *outputs);
+
+// Converts planar float channels into interleaved frames, rounding to nearest and saturating.
+void PCMS16InterleaveFromFloat(const float *const *inputs, size_t frames, uint16_t channels, int16_t *output);
+
+// Splits data made of alternating primary and secondary blocks into two buffers in single pass. Once either of them is
+// filled, rest of the input belongs to the other one. Blocks of one and two samples are vectorized.
+void PCMS16SplitInterleavedBlocks(const char *input, size_t primaryBlockSize, size_t secondaryBlockSize, char *primary, size_t primarySize, char *secondary,
+                                  size_t secondarySize);
+
+// Inverse of PCMS16SplitInterleavedBlocks, output must be large enough to hold both buffers.
+void PCMS16MergeInterleavedBlocks(const char *primary, size_t primarySize, const char *secondary, size_t secondarySize, size_t primaryBlockSize,
+                                  size_t secondaryBlockSize, char *output);
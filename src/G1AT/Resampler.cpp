@@ -0,0 +1,299 @@
+//
+// Created by Andrej Redeky.
+// Copyright © 2015-2023 Feldarian Softworks. All rights reserved.
+// SPDX-License-Identifier: EUPL-1.2
+//
+
+#include <Precompiled.hpp>
+
+#include "Resampler.hpp"
+
+#include "Remix.hpp"
+#include "SIMD.hpp"
+
+namespace
+{
+
+// Phases are quantized above this count, so odd pairs of sample rates do not blow up memory.
+constexpr uint64_t resamplerMaxPhases = 1024;
+constexpr uint32_t resamplerTapsAlignment = 8;
+constexpr uint16_t resamplerMaxChannels = 8;
+
+struct ResamplerQualityParameters
+{
+  uint32_t zeroCrossings;
+  double rolloff;
+};
+
+constexpr std::array<ResamplerQualityParameters, 3> resamplerQualityParameters{{
+  {8, 0.90},
+  {16, 0.95},
+  {32, 0.97},
+}};
+
+float DotProductScalar(const float *samples, const float *coefficients, const uint32_t count)
+{
+  float sum = 0.0f;
+  for (uint32_t i = 0; i < count; ++i)
+    sum += samples[i] * coefficients[i];
+
+  return sum;
+}
+
+#if G1AT_SIMD_X86
+
+G1AT_TARGET_SSE41 float DotProductSSE41(const float *samples, const float *coefficients, const uint32_t count)
+{
+  auto sum = _mm_setzero_ps();
+  for (uint32_t i = 0; i < count; i += 4)
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(coefficients + i)));
+
+  sum = _mm_hadd_ps(sum, sum);
+  sum = _mm_hadd_ps(sum, sum);
+  return _mm_cvtss_f32(sum);
+}
+
+G1AT_TARGET_AVX2 float DotProductAVX2(const float *samples, const float *coefficients, const uint32_t count)
+{
+  auto sum = _mm256_setzero_ps();
+  for (uint32_t i = 0; i < count; i += 8)
+    sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(samples + i), _mm256_loadu_ps(coefficients + i)));
+
+  auto halfSum = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+  halfSum = _mm_hadd_ps(halfSum, halfSum);
+  halfSum = _mm_hadd_ps(halfSum, halfSum);
+  return _mm_cvtss_f32(halfSum);
+}
+
+#elif G1AT_SIMD_NEON
+
+float DotProductNEON(const float *samples, const float *coefficients, const uint32_t count)
+{
+  auto sum = vdupq_n_f32(0.0f);
+  for (uint32_t i = 0; i < count; i += 4)
+    sum = vmlaq_f32(sum, vld1q_f32(samples + i), vld1q_f32(coefficients + i));
+
+  return vaddvq_f32(sum);
+}
+
+#endif
+
+std::shared_ptr<const PCMS16ResamplerFilterBank> BuildFilterBank(const uint32_t sourceSampleRate, const uint32_t targetSampleRate, const ResamplerQuality quality)
+{
+  const auto &parameters = resamplerQualityParameters[static_cast<size_t>(quality)];
+
+  auto filterBank = std::make_shared<PCMS16ResamplerFilterBank>();
+
+  const auto divisor = std::gcd(sourceSampleRate, targetSampleRate);
+  filterBank->sourceStep = sourceSampleRate / divisor;
+  filterBank->targetStep = targetSampleRate / divisor;
+  filterBank->phasesCount = static_cast<uint32_t>(std::min(filterBank->targetStep, resamplerMaxPhases));
+
+  const auto scale = parameters.rolloff * std::min(1.0, static_cast<double>(targetSampleRate) / sourceSampleRate);
+  filterBank->halfWidth = static_cast<uint32_t>(std::ceil(parameters.zeroCrossings / scale));
+  filterBank->tapsCount = (2 * filterBank->halfWidth + resamplerTapsAlignment - 1) / resamplerTapsAlignment * resamplerTapsAlignment;
+
+  filterBank->coefficients.resize(static_cast<size_t>(filterBank->phasesCount) * filterBank->tapsCount, 0.0f);
+  for (uint32_t phase = 0; phase < filterBank->phasesCount; ++phase)
+  {
+    auto *phaseCoefficients = filterBank->coefficients.data() + static_cast<size_t>(phase) * filterBank->tapsCount;
+    const auto fraction = static_cast<double>(phase) / filterBank->phasesCount;
+
+    double sum = 0.0;
+    for (uint32_t tap = 0; tap < 2 * filterBank->halfWidth; ++tap)
+    {
+      const auto position = static_cast<double>(tap) - filterBank->halfWidth + 1 - fraction;
+      if (std::abs(position) >= filterBank->halfWidth)
+        continue;
+
+      const auto sincPosition = std::numbers::pi * scale * position;
+      const auto sinc = position == 0.0 ? 1.0 : std::sin(sincPosition) / sincPosition;
+      const auto windowPosition = std::numbers::pi * position / filterBank->halfWidth;
+      const auto window = 0.42 + 0.5 * std::cos(windowPosition) + 0.08 * std::cos(2.0 * windowPosition);
+      const auto coefficient = scale * sinc * window;
+
+      phaseCoefficients[tap] = static_cast<float>(coefficient);
+      sum += coefficient;
+    }
+
+    // NOTE - normalized per phase, so constant signal passes through unchanged in every phase
+    for (uint32_t tap = 0; tap < 2 * filterBank->halfWidth; ++tap)
+      phaseCoefficients[tap] = static_cast<float>(phaseCoefficients[tap] / sum);
+  }
+
+  return filterBank;
+}
+
+}
+
+std::shared_ptr<const PCMS16ResamplerFilterBank> PCMS16ResamplerFilterBank::Get(const uint32_t sourceSampleRate, const uint32_t targetSampleRate,
+                                                                                const ResamplerQuality quality)
+{
+  static std::shared_mutex filterBanksMutex;
+  static OrderedMap<uint64_t, std::shared_ptr<const PCMS16ResamplerFilterBank>> filterBanks;
+
+  const auto key = (static_cast<uint64_t>(sourceSampleRate) << 33) | (static_cast<uint64_t>(targetSampleRate) << 2) | static_cast<uint64_t>(quality);
+
+  {
+    std::shared_lock lock(filterBanksMutex);
+    const auto filterBankIt = filterBanks.find(key);
+    if (filterBankIt != filterBanks.end())
+      return filterBankIt->second;
+  }
+
+  auto filterBank = BuildFilterBank(sourceSampleRate, targetSampleRate, quality);
+
+  std::unique_lock lock(filterBanksMutex);
+  return filterBanks.try_emplace(key, std::move(filterBank)).first->second;
+}
+
+bool PCMS16Resampler::Reset(const uint32_t newSourceSampleRate, const uint32_t newTargetSampleRate, const uint16_t newChannels, const ResamplerQuality quality)
+{
+  if (newSourceSampleRate == 0 || newTargetSampleRate == 0 || newChannels == 0 || newChannels > resamplerMaxChannels)
+    return false;
+
+  if (static_cast<size_t>(quality) >= resamplerQualityParameters.size())
+    return false;
+
+  sourceSampleRate = newSourceSampleRate;
+  targetSampleRate = newTargetSampleRate;
+  channels = newChannels;
+
+  filterBank = PCMS16ResamplerFilterBank::Get(sourceSampleRate, targetSampleRate, quality);
+
+  switch (GetSIMDLevel())
+  {
+#if G1AT_SIMD_X86
+    case SIMDLevel::AVX2: {
+      dotProduct = DotProductAVX2;
+      break;
+    }
+    case SIMDLevel::SSE41: {
+      dotProduct = DotProductSSE41;
+      break;
+    }
+#elif G1AT_SIMD_NEON
+    case SIMDLevel::NEON: {
+      dotProduct = DotProductNEON;
+      break;
+    }
+#endif
+    default: {
+      dotProduct = DotProductScalar;
+      break;
+    }
+  }
+
+  switch (channels)
+  {
+    case 1: {
+      produce = &PCMS16Resampler::Produce<1>;
+      break;
+    }
+    case 2: {
+      produce = &PCMS16Resampler::Produce<2>;
+      break;
+    }
+    default: {
+      produce = &PCMS16Resampler::Produce<0>;
+      break;
+    }
+  }
+
+  history.resize(channels);
+  for (auto &channelHistory : history)
+    channelHistory.assign(filterBank->halfWidth, 0.0f);
+
+  resampled.resize(channels);
+
+  historyBeginFrame = -static_cast<int64_t>(filterBank->halfWidth);
+  inputFrames = 0;
+  outputFrames = 0;
+
+  return true;
+}
+
+uint64_t PCMS16Resampler::GetOutputFrames(const uint64_t frames) const
+{
+  if (sourceSampleRate == 0)
+    return 0;
+
+  return (frames * targetSampleRate + sourceSampleRate - 1) / sourceSampleRate;
+}
+
+size_t PCMS16Resampler::Process(const std::span<const int16_t> &input, std::vector<int16_t> &output)
+{
+  const auto framesCount = input.size() / channels;
+
+  std::array<float *, resamplerMaxChannels> historyOutputs{};
+  for (uint16_t channel = 0; channel < channels; ++channel)
+  {
+    auto &channelHistory = history[channel];
+    const auto historyOffset = channelHistory.size();
+    channelHistory.resize(historyOffset + framesCount);
+    historyOutputs[channel] = channelHistory.data() + historyOffset;
+  }
+
+  PCMS16DeinterleaveToFloat(input.data(), framesCount, channels, historyOutputs.data());
+
+  inputFrames += framesCount;
+
+  return (this->*produce)(output, std::numeric_limits<uint64_t>::max());
+}
+
+size_t PCMS16Resampler::Flush(std::vector<int16_t> &output)
+{
+  for (auto &channelHistory : history)
+    channelHistory.resize(channelHistory.size() + filterBank->tapsCount + 1, 0.0f);
+
+  return (this->*produce)(output, GetOutputFrames(inputFrames));
+}
+
+template <uint16_t Channels>
+size_t PCMS16Resampler::Produce(std::vector<int16_t> &output, const uint64_t outputFramesLimit)
+{
+  const auto channelsCount = Channels != 0 ? Channels : channels;
+  const auto &bank = *filterBank;
+  const auto historyFrames = static_cast<int64_t>(history.front().size());
+
+  for (auto &channelResampled : resampled)
+    channelResampled.clear();
+
+  while (outputFrames < outputFramesLimit)
+  {
+    const auto position = outputFrames * bank.sourceStep;
+    const auto centerFrame = static_cast<int64_t>(position / bank.targetStep);
+    const auto firstFrame = centerFrame - bank.halfWidth + 1;
+    if (firstFrame + bank.tapsCount > historyBeginFrame + historyFrames)
+      break;
+
+    auto phase = position % bank.targetStep;
+    if (bank.phasesCount != bank.targetStep)
+      phase = phase * bank.phasesCount / bank.targetStep;
+
+    const auto *coefficients = bank.coefficients.data() + phase * bank.tapsCount;
+    const auto historyOffset = static_cast<size_t>(firstFrame - historyBeginFrame);
+    for (uint16_t channel = 0; channel < channelsCount; ++channel)
+      resampled[channel].emplace_back(dotProduct(history[channel].data() + historyOffset, coefficients, bank.tapsCount));
+
+    ++outputFrames;
+  }
+
+  const auto nextFirstFrame = static_cast<int64_t>(outputFrames * bank.sourceStep / bank.targetStep) - bank.halfWidth + 1;
+  const auto droppedFrames = std::clamp<int64_t>(nextFirstFrame - historyBeginFrame, 0, historyFrames);
+  for (auto &channelHistory : history)
+    channelHistory.erase(channelHistory.begin(), channelHistory.begin() + droppedFrames);
+
+  historyBeginFrame += droppedFrames;
+
+  std::array<const float *, resamplerMaxChannels> resampledInputs{};
+  for (uint16_t channel = 0; channel < channelsCount; ++channel)
+    resampledInputs[channel] = resampled[channel].data();
+
+  const auto resampledFrames = resampled.front().size();
+  const auto outputOffset = output.size();
+  output.resize(outputOffset + resampledFrames * channelsCount);
+  PCMS16InterleaveFromFloat(resampledInputs.data(), resampledFrames, channelsCount, output.data() + outputOffset);
+
+  return resampledFrames;
+}
@@ -0,0 +1,60 @@
+//
+// Created by Andrej Redeky.
+// Copyright © 2015-2023 Feldarian Softworks. All rights reserved.
+// SPDX-License-Identifier: EUPL-1.2
+//
+
+#pragma once
+
+enum class ResamplerQuality : uint8_t
+{
+  FAST,
+  BALANCED,
+  HIGH
+};
+
+// Polyphase filter bank for single combination of sample rates and quality. Banks are built once and cached for the
+// whole run of the application, as archives use only handful of distinct sample rates.
+struct PCMS16ResamplerFilterBank
+{
+  static std::shared_ptr<const PCMS16ResamplerFilterBank> Get(uint32_t sourceSampleRate, uint32_t targetSampleRate, ResamplerQuality quality);
+
+  std::vector<float> coefficients; // phasesCount rows of tapsCount coefficients each
+  uint64_t sourceStep = 0;
+  uint64_t targetStep = 0;
+  uint32_t phasesCount = 0;
+  uint32_t tapsCount = 0;
+  uint32_t halfWidth = 0;
+};
+
+// Streaming band-limited resampler for interleaved PCM S16 frames. Input may be pushed in blocks of any size, only
+// filter-sized history is kept between blocks, so memory use does not depend on the length of the stream.
+class PCMS16Resampler
+{
+public:
+  bool Reset(uint32_t sourceSampleRate, uint32_t targetSampleRate, uint16_t channels, ResamplerQuality quality = ResamplerQuality::BALANCED);
+
+  uint64_t GetOutputFrames(uint64_t inputFrames) const;
+
+  // Appends resampled frames to the output, returns number of appended frames.
+  size_t Process(const std::span<const int16_t> &input, std::vector<int16_t> &output);
+  // Resamples remaining history up to the final expected length, appending to the output.
+  size_t Flush(std::vector<int16_t> &output);
+
+private:
+  // Channels of 0 means channel count known only at runtime.
+  template <uint16_t Channels>
+  size_t Produce(std::vector<int16_t> &output, uint64_t outputFramesLimit);
+
+  std::shared_ptr<const PCMS16ResamplerFilterBank> filterBank;
+  size_t (PCMS16Resampler::*produce)(std::vector<int16_t> &, uint64_t) = nullptr;
+  float (*dotProduct)(const float *, const float *, uint32_t) = nullptr;
+  std::vector<std::vector<float>> history; // planar, one row per channel
+  std::vector<std::vector<float>> resampled; // planar, one row per channel
+  int64_t historyBeginFrame = 0;
+  uint64_t inputFrames = 0;
+  uint64_t outputFrames = 0;
+  uint32_t sourceSampleRate = 0;
+  uint32_t targetSampleRate = 0;
+  uint16_t channels = 0;
+};
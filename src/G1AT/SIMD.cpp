@@ -0,0 +1,170 @@
+//
+// Created by Andrej Redeky.
+// Copyright © 2015-2023 Feldarian Softworks. All rights reserved.
+// SPDX-License-Identifier: EUPL-1.2
+//
+
+#include <Precompiled.hpp>
+
+#include "SIMD.hpp"
+
+#if G1AT_SIMD_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+
+SIMDLevel DetectSIMDLevel()
+{
+#if G1AT_SIMD_X86
+#if defined(_MSC_VER)
+  std::array<int, 4> cpuInfo{};
+  __cpuid(cpuInfo.data(), 0);
+  const auto maxLeaf = cpuInfo[0];
+
+  __cpuid(cpuInfo.data(), 1);
+  const auto hasSSE41 = (cpuInfo[2] & (1 << 19)) != 0;
+  const auto hasOSXSAVE = (cpuInfo[2] & (1 << 27)) != 0;
+  const auto hasAVX = (cpuInfo[2] & (1 << 28)) != 0;
+
+  auto hasAVX2 = false;
+  if (maxLeaf >= 7 && hasOSXSAVE && hasAVX && (_xgetbv(0) & 0x6) == 0x6)
+  {
+    __cpuidex(cpuInfo.data(), 7, 0);
+    hasAVX2 = (cpuInfo[1] & (1 << 5)) != 0;
+  }
+
+  if (hasAVX2)
+    return SIMDLevel::AVX2;
+
+  if (hasSSE41)
+    return SIMDLevel::SSE41;
+#else
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2"))
+    return SIMDLevel::AVX2;
+
+  if (__builtin_cpu_supports("sse4.1"))
+    return SIMDLevel::SSE41;
+#endif
+#elif G1AT_SIMD_NEON
+  // NOTE - NEON is mandatory on AArch64
+  return SIMDLevel::NEON;
+#endif
+
+  return SIMDLevel::SCALAR;
+}
+
+bool IsZeroWindowScalar(const char *window, const size_t windowSize)
+{
+  uint64_t accumulator = 0;
+  size_t offset = 0;
+  for (; offset + sizeof(uint64_t) <= windowSize; offset += sizeof(uint64_t))
+  {
+    uint64_t value;
+    std::memcpy(&value, window + offset, sizeof(uint64_t));
+    accumulator |= value;
+  }
+
+  for (; offset < windowSize; ++offset)
+    accumulator |= static_cast<uint8_t>(window[offset]);
+
+  return accumulator == 0;
+}
+
+#if G1AT_SIMD_X86
+
+G1AT_TARGET_SSE41 bool IsZeroWindowSSE41(const char *window, const size_t windowSize)
+{
+  auto accumulator = _mm_setzero_si128();
+  size_t offset = 0;
+  for (; offset + 16 <= windowSize; offset += 16)
+    accumulator = _mm_or_si128(accumulator, _mm_loadu_si128(reinterpret_cast<const __m128i *>(window + offset)));
+
+  return _mm_testz_si128(accumulator, accumulator) != 0 && IsZeroWindowScalar(window + offset, windowSize - offset);
+}
+
+G1AT_TARGET_AVX2 bool IsZeroWindowAVX2(const char *window, const size_t windowSize)
+{
+  auto accumulator = _mm256_setzero_si256();
+  size_t offset = 0;
+  for (; offset + 32 <= windowSize; offset += 32)
+    accumulator = _mm256_or_si256(accumulator, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(window + offset)));
+
+  return _mm256_testz_si256(accumulator, accumulator) != 0 && IsZeroWindowScalar(window + offset, windowSize - offset);
+}
+
+#elif G1AT_SIMD_NEON
+
+bool IsZeroWindowNEON(const char *window, const size_t windowSize)
+{
+  auto accumulator = vdupq_n_u8(0);
+  size_t offset = 0;
+  for (; offset + 16 <= windowSize; offset += 16)
+    accumulator = vorrq_u8(accumulator, vld1q_u8(reinterpret_cast<const uint8_t *>(window + offset)));
+
+  return vmaxvq_u8(accumulator) == 0 && IsZeroWindowScalar(window + offset, windowSize - offset);
+}
+
+#endif
+
+}
+
+SIMDLevel GetSIMDLevel()
+{
+  static const auto simdLevel = DetectSIMDLevel();
+  return simdLevel;
+}
+
+SIMDLevel GetSIMDLevel(const SIMDLevel requestedLevel)
+{
+  const auto simdLevel = GetSIMDLevel();
+  if (requestedLevel == SIMDLevel::SCALAR)
+    return requestedLevel;
+
+  if (simdLevel == SIMDLevel::NEON || requestedLevel == SIMDLevel::NEON)
+    return simdLevel;
+
+  return std::min(requestedLevel, simdLevel);
+}
+
+std::vector<bool> FindZeroWindows(const char *data, const size_t dataSize, const size_t windowOffset, const size_t windowSize, const size_t stride,
+                                  const size_t windowsCount)
+{
+  bool (*isZeroWindow)(const char *, size_t) = IsZeroWindowScalar;
+  switch (GetSIMDLevel())
+  {
+#if G1AT_SIMD_X86
+    case SIMDLevel::AVX2: {
+      isZeroWindow = IsZeroWindowAVX2;
+      break;
+    }
+    case SIMDLevel::SSE41: {
+      isZeroWindow = IsZeroWindowSSE41;
+      break;
+    }
+#elif G1AT_SIMD_NEON
+    case SIMDLevel::NEON: {
+      isZeroWindow = IsZeroWindowNEON;
+      break;
+    }
+#endif
+    default: {
+      break;
+    }
+  }
+
+  std::vector<bool> zeroWindows(windowsCount, false);
+  for (size_t index = 0; index < windowsCount; ++index)
+  {
+    const auto windowBegin = windowOffset + index * stride;
+    if (windowBegin + windowSize > dataSize)
+      break;
+
+    zeroWindows[index] = isZeroWindow(data + windowBegin, windowSize);
+  }
+
+  return zeroWindows;
+}
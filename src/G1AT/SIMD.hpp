@@ -0,0 +1,42 @@
+//
+// Created by Andrej Redeky.
+// Copyright © 2015-2023 Feldarian Softworks. All rights reserved.
+// SPDX-License-Identifier: EUPL-1.2
+//
+
+#pragma once
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define G1AT_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define G1AT_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// NOTE - MSVC allows intrinsics from any instruction set everywhere, GCC and Clang need them enabled per function
+#if defined(__GNUC__) || defined(__clang__)
+#define G1AT_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define G1AT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define G1AT_TARGET_SSE41
+#define G1AT_TARGET_AVX2
+#endif
+
+enum class SIMDLevel : uint8_t
+{
+  SCALAR,
+  SSE41,
+  AVX2,
+  NEON
+};
+
+// Best instruction set supported by both the build and the CPU running it, detected once.
+SIMDLevel GetSIMDLevel();
+
+// Requested level if it is supported, best supported level otherwise.
+SIMDLevel GetSIMDLevel(SIMDLevel requestedLevel);
+
+// Flags each window of windowSize bytes starting at windowOffset + index * stride that contains only zero bytes. Windows
+// reaching past the end of data are never flagged.
+std::vector<bool> FindZeroWindows(const char *data, size_t dataSize, size_t windowOffset, size_t windowSize, size_t stride, size_t windowsCount);
@@ -8,6 +8,18 @@
 
 #ifdef G1AT_BUILD_TESTS
 
+#include "ADPCM.hpp"
+#include "Hitman1ArchiveDialog.hpp"
+#include "Hitman23ArchiveDialog.hpp"
+#include "Hitman4ArchiveDialog.hpp"
+#include "Remix.hpp"
+#include "Transcode.hpp"
+#include "Utils.hpp"
+
+#include <Core/Log.hpp>
+
+#include <random>
+
 namespace
 {
 
@@ -999,11 +1011,1169 @@ void TestStringImpls()
   TestStringImpl<StringViewWCI, false>();
 }
 
+// Sine wave with noise, different for every channel, which gives encoders something else than silence to work with.
+std::vector<int16_t> GenerateTestFrames(const uint64_t framesCount, const uint32_t channels, const uint32_t seed)
+{
+  std::mt19937 random(seed);
+  std::normal_distribution<double> noise(0.0, 2000.0);
+  std::vector<int16_t> frames(framesCount * channels);
+  for (uint64_t frame = 0; frame < framesCount; ++frame)
+  {
+    for (uint32_t channel = 0; channel < channels; ++channel)
+      frames[frame * channels + channel] = static_cast<int16_t>(std::clamp(16000.0 * std::sin(frame * 0.01 * (channel + 1)) + noise(random), -32768.0, 32767.0));
+  }
+
+  return frames;
+}
+
+AudioDataInfo PCMS16TestRecord(const uint32_t sampleRate, const uint16_t channels, const size_t samplesCount)
+{
+  AudioDataInfo pcms16Record{};
+  pcms16Record.format = AudioDataFormat::PCM_S16;
+  pcms16Record.sampleRate = sampleRate;
+  pcms16Record.channels = channels;
+  pcms16Record.bitsPerSample = 16;
+  pcms16Record.blockAlign = static_cast<uint16_t>(channels * sizeof(int16_t));
+  pcms16Record.samplesPerBlock = 1;
+  pcms16Record.dataSize = static_cast<uint32_t>(samplesCount * sizeof(int16_t));
+  pcms16Record.dataSizeUncompressed = pcms16Record.dataSize;
+  return pcms16Record;
+}
+
+std::span<const char> AsBytes(const std::vector<int16_t> &samples)
+{
+  return {reinterpret_cast<const char *>(samples.data()), samples.size() * sizeof(int16_t)};
+}
+
+void TestADPCMDecoder()
+{
+  constexpr uint32_t blocksCount = 1023;
+
+  for (const uint32_t channels : {1u, 2u})
+  {
+    const auto blockAlign = 0x400 * channels;
+    const auto samplesPerBlock = ADPCMSamplesPerBlock(blockAlign, channels);
+
+    // NOTE - any bytes are valid IMA ADPCM data, partial last block and out of range step indices included
+    std::mt19937 random(channels);
+    std::vector<char> adpcmData(blocksCount * blockAlign + blockAlign / 3);
+    ranges::generate(adpcmData, [&random] { return static_cast<char>(random()); });
+
+    const auto maxFrames = static_cast<uint64_t>(blocksCount + 1) * samplesPerBlock;
+    std::vector<int16_t> scalarFrames(maxFrames * channels);
+    [[maybe_unused]] const auto scalarFramesCount = ADPCMDecodeBlocks(adpcmData, blockAlign, channels, scalarFrames.data(), maxFrames, SIMDLevel::SCALAR);
+    assert(scalarFramesCount > static_cast<uint64_t>(blocksCount) * samplesPerBlock);
+
+    for (const auto simdLevel : {SIMDLevel::SCALAR, SIMDLevel::SSE41, SIMDLevel::AVX2, SIMDLevel::NEON})
+    {
+      if (GetSIMDLevel(simdLevel) != simdLevel)
+        continue;
+
+      std::vector<int16_t> frames(maxFrames * channels);
+      [[maybe_unused]] const auto framesCount = ADPCMDecodeBlocks(adpcmData, blockAlign, channels, frames.data(), maxFrames, simdLevel);
+      assert(framesCount == scalarFramesCount);
+      assert(frames == scalarFrames);
+    }
+  }
+}
+
+// Load hashes of IMA ADPCM data come from our decoder, they have to stay same as hashes in existing original records.
+void TestADPCMDecoderMatchesLibrary()
+{
+  constexpr uint64_t framesCount = 123457;
+
+  for (const uint16_t channels : {1, 2})
+  {
+    const auto frames = GenerateTestFrames(framesCount, channels, 7 + channels);
+    const auto pcms16Header = PCMS16Header(PCMS16TestRecord(22050, channels, frames.size()));
+
+    std::vector<char> libraryData;
+    [[maybe_unused]] const auto libraryEncoded = PCMS16ToADPCM(pcms16Header, frames, libraryData, AudioConversionFlag::RAWOutput);
+    assert(libraryEncoded);
+    const auto libraryRecord = ADPCMSoundRecord(ADPCMHeader(PCMS16SoundRecord(pcms16Header)), libraryData);
+
+    TranscodeFormat targetFormat{AudioDataFormat::IMA_ADPCM, 22050, channels};
+    std::vector<char> transcodedData;
+    AudioDataInfo transcodedRecord{};
+    [[maybe_unused]] const auto transcoded = TranscodeSoundData(PCMS16TestRecord(22050, channels, frames.size()), AsBytes(frames), targetFormat, transcodedData, transcodedRecord);
+    assert(transcoded);
+
+    for (const auto &[adpcmRecord, adpcmData] : {std::pair{libraryRecord, libraryData}, std::pair{transcodedRecord, transcodedData}})
+    {
+      std::vector<int16_t> libraryFrames;
+      [[maybe_unused]] const auto libraryDecoded = PCMS16FromSoundData(adpcmRecord, adpcmData, libraryFrames, AudioConversionFlag::RAWOutput);
+      assert(libraryDecoded);
+      assert(libraryFrames.size() == framesCount * channels);
+
+      for (const auto simdLevel : {SIMDLevel::SCALAR, SIMDLevel::SSE41, SIMDLevel::AVX2, SIMDLevel::NEON})
+      {
+        if (GetSIMDLevel(simdLevel) != simdLevel)
+          continue;
+
+        std::vector<int16_t> decodedFrames(libraryFrames.size());
+        [[maybe_unused]] const auto decodedFramesCount = ADPCMDecodeBlocks(adpcmData, adpcmRecord.blockAlign, channels, decodedFrames.data(), framesCount, simdLevel);
+        assert(decodedFramesCount == framesCount);
+        assert(decodedFrames == libraryFrames);
+      }
+
+      [[maybe_unused]] const auto hashedRecord = HashedSoundRecord(adpcmRecord, adpcmData);
+      [[maybe_unused]] const auto libraryHashedRecord = SoundDataSoundRecord(adpcmRecord, adpcmData);
+      assert(hashedRecord.dataXXH3 != 0);
+      assert(hashedRecord.dataXXH3 == libraryHashedRecord.dataXXH3);
+    }
+
+    // Vorbis imports are compared against hashes of loaded and encoded Vorbis records, all of them have to agree
+    std::vector<char> vorbisData;
+    AudioDataInfo vorbisRecord{};
+    [[maybe_unused]] const auto vorbisTranscoded = TranscodeSoundData(PCMS16TestRecord(22050, channels, frames.size()), AsBytes(frames),
+                                                                      {AudioDataFormat::OGG_VORBIS, 22050, channels}, vorbisData, vorbisRecord);
+    assert(vorbisTranscoded);
+
+    [[maybe_unused]] const auto hashedRecord = HashedSoundRecord(vorbisRecord, vorbisData);
+    [[maybe_unused]] const auto libraryHashedRecord = SoundDataSoundRecord(vorbisRecord, vorbisData);
+    assert(hashedRecord.dataXXH3 != 0);
+    assert(hashedRecord.dataXXH3 == libraryHashedRecord.dataXXH3);
+    assert(hashedRecord.dataXXH3 == vorbisRecord.dataXXH3);
+    assert(PCMS16SoundDataXXH3(vorbisRecord, vorbisData) == libraryHashedRecord.dataXXH3);
+  }
+}
+
+[[maybe_unused]] double RMSError(const std::vector<int16_t> &frames, const std::vector<int16_t> &expectedFrames)
+{
+  double squaredError = 0.0;
+  for (size_t sample = 0; sample < frames.size(); ++sample)
+  {
+    const auto error = static_cast<double>(frames[sample]) - expectedFrames[sample];
+    squaredError += error * error;
+  }
+
+  return std::sqrt(squaredError / static_cast<double>(std::max<size_t>(frames.size(), 1)));
+}
+
+std::vector<int16_t> GenerateSines(const uint64_t framesCount, const uint32_t sampleRate, const std::initializer_list<std::pair<double, double>> &sines)
+{
+  std::vector<int16_t> frames(framesCount);
+  for (uint64_t frame = 0; frame < framesCount; ++frame)
+  {
+    double sample = 0.0;
+    for (const auto &[frequency, amplitude] : sines)
+      sample += amplitude * std::sin(2.0 * std::numbers::pi * frequency * static_cast<double>(frame) / sampleRate);
+
+    frames[frame] = static_cast<int16_t>(std::lround(sample));
+  }
+
+  return frames;
+}
+
+[[maybe_unused]] double SineAmplitude(const std::vector<int16_t> &frames, const double frequency, const uint32_t sampleRate)
+{
+  // NOTE - skip filter warm-up at both ends of the stream
+  const auto margin = frames.size() / 8;
+  double sumSin = 0.0;
+  double sumCos = 0.0;
+  for (size_t frame = margin; frame < frames.size() - margin; ++frame)
+  {
+    const auto phase = 2.0 * std::numbers::pi * frequency * static_cast<double>(frame) / sampleRate;
+    sumSin += frames[frame] * std::sin(phase);
+    sumCos += frames[frame] * std::cos(phase);
+  }
+
+  return 2.0 * std::hypot(sumSin, sumCos) / static_cast<double>(frames.size() - 2 * margin);
+}
+
+void TestTranscodePipeline()
+{
+  constexpr uint64_t framesCount = 98765;
+
+  for (const uint16_t channels : {1, 2})
+  {
+    const auto frames = GenerateTestFrames(framesCount, channels, 11 + channels);
+    const auto pcms16Record = PCMS16TestRecord(22050, channels, frames.size());
+
+    // PCM -> IMA ADPCM -> PCM has to lose no more than encoder of the library does
+    std::vector<char> libraryData;
+    [[maybe_unused]] const auto libraryEncoded = PCMS16ToADPCM(PCMS16Header(pcms16Record), frames, libraryData, AudioConversionFlag::RAWOutput);
+    assert(libraryEncoded);
+    std::vector<int16_t> libraryFrames;
+    [[maybe_unused]] const auto libraryDecoded =
+        PCMS16FromSoundData(ADPCMSoundRecord(ADPCMHeader(PCMS16SoundRecord(PCMS16Header(pcms16Record))), libraryData), libraryData, libraryFrames,
+                            AudioConversionFlag::RAWOutput);
+    assert(libraryDecoded);
+    assert(libraryFrames.size() == frames.size());
+
+    std::vector<char> adpcmData;
+    AudioDataInfo adpcmRecord{};
+    [[maybe_unused]] const auto adpcmTranscoded =
+        TranscodeSoundData(pcms16Record, AsBytes(frames), {AudioDataFormat::IMA_ADPCM, 22050, channels}, adpcmData, adpcmRecord);
+    assert(adpcmTranscoded);
+    assert(adpcmRecord.format == AudioDataFormat::IMA_ADPCM);
+    std::vector<int16_t> adpcmFrames;
+    [[maybe_unused]] const auto adpcmDecoded = PCMS16FromSoundData(adpcmRecord, adpcmData, adpcmFrames, AudioConversionFlag::RAWOutput);
+    assert(adpcmDecoded);
+    assert(adpcmFrames.size() == frames.size());
+    assert(RMSError(adpcmFrames, frames) <= RMSError(libraryFrames, frames) * 1.05 + 1.0);
+
+    // Remix and resample, output length is given by the resampler only
+    for (const auto &[targetSampleRate, targetChannels] : {std::pair<uint32_t, uint16_t>{11025, 1}, {44100, 2}, {48000, 1}})
+    {
+      std::vector<char> pcms16Data;
+      AudioDataInfo resampledRecord{};
+      [[maybe_unused]] const auto resampled =
+          TranscodeSoundData(pcms16Record, AsBytes(frames), {AudioDataFormat::PCM_S16, targetSampleRate, targetChannels}, pcms16Data, resampledRecord);
+      assert(resampled);
+      assert(resampledRecord.sampleRate == targetSampleRate);
+      assert(resampledRecord.channels == targetChannels);
+
+      PCMS16Resampler resampler;
+      resampler.Reset(22050, targetSampleRate, targetChannels);
+      [[maybe_unused]] const auto expectedFrames = resampler.GetOutputFrames(framesCount);
+      assert(expectedFrames == (framesCount * targetSampleRate + 22049) / 22050);
+      assert(pcms16Data.size() == expectedFrames * targetChannels * sizeof(int16_t));
+      assert(resampledRecord.dataSize == pcms16Data.size());
+    }
+
+    // Vorbis has to decode back to the length of the input
+    std::vector<char> vorbisData;
+    AudioDataInfo vorbisRecord{};
+    [[maybe_unused]] const auto vorbisTranscoded =
+        TranscodeSoundData(pcms16Record, AsBytes(frames), {AudioDataFormat::OGG_VORBIS, 22050, channels}, vorbisData, vorbisRecord);
+    assert(vorbisTranscoded);
+    assert(vorbisRecord.format == AudioDataFormat::OGG_VORBIS);
+    std::vector<int16_t> vorbisFrames;
+    [[maybe_unused]] const auto vorbisDecoded = PCMS16FromSoundData(vorbisRecord, vorbisData, vorbisFrames, AudioConversionFlag::RAWOutput);
+    assert(vorbisDecoded);
+    assert(vorbisFrames.size() == frames.size());
+
+    PCMS16BlockReader reader;
+    [[maybe_unused]] const auto readerOpened = reader.Open(vorbisRecord, vorbisData);
+    assert(readerOpened);
+    std::vector<int16_t> readerFrames(transcodeBlockFrames * channels);
+    uint64_t readerFramesCount = 0;
+    size_t readFrames = 0;
+    while ((readFrames = reader.Read(readerFrames.data(), transcodeBlockFrames)) != 0)
+      readerFramesCount += readFrames;
+    assert(readerFramesCount == framesCount);
+  }
+}
+
+void TestResampler()
+{
+  constexpr double passFrequency = 1000.0;
+  constexpr double amplitude = 8000.0;
+  constexpr size_t chunkFrames = 1000;
+
+  for (const auto quality : {ResamplerQuality::FAST, ResamplerQuality::BALANCED, ResamplerQuality::HIGH})
+  {
+    for (const auto &[sourceSampleRate, targetSampleRate] :
+         {std::pair<uint32_t, uint32_t>{22050, 44100}, {22050, 48000}, {11025, 22050}, {44100, 22050}, {48000, 11025}, {44100, 32000}})
+    {
+      const auto downsample = sourceSampleRate > targetSampleRate;
+      // NOTE - halfway between Nyquist frequencies of both rates, so only filter of the resampler can remove it
+      const auto stopFrequency = (sourceSampleRate + targetSampleRate) / 4.0;
+      const auto frames = downsample ? GenerateSines(sourceSampleRate * 2, sourceSampleRate, {{passFrequency, amplitude}, {stopFrequency, amplitude}})
+                                     : GenerateSines(sourceSampleRate * 2, sourceSampleRate, {{passFrequency, amplitude}});
+
+      PCMS16Resampler resampler;
+      [[maybe_unused]] const auto resamplerReset = resampler.Reset(sourceSampleRate, targetSampleRate, 1, quality);
+      assert(resamplerReset);
+
+      std::vector<int16_t> chunkedFrames;
+      for (size_t frame = 0; frame < frames.size(); frame += chunkFrames)
+        resampler.Process(std::span(frames).subspan(frame, std::min(chunkFrames, frames.size() - frame)), chunkedFrames);
+      resampler.Flush(chunkedFrames);
+      assert(chunkedFrames.size() == resampler.GetOutputFrames(frames.size()));
+
+      std::vector<int16_t> resampledFrames;
+      resampler.Reset(sourceSampleRate, targetSampleRate, 1, quality);
+      resampler.Process(frames, resampledFrames);
+      resampler.Flush(resampledFrames);
+      assert(resampledFrames == chunkedFrames);
+
+      assert(std::abs(SineAmplitude(resampledFrames, passFrequency, targetSampleRate) - amplitude) < amplitude / 100);
+
+      // Leftovers of stop band tone fold back under Nyquist frequency of the target, images of upsampled tone land
+      // right under the source sample rate. Both have to be at least 60 dB down.
+      [[maybe_unused]] const auto aliasFrequency = downsample
+                                                       ? std::abs(stopFrequency - std::round(stopFrequency / targetSampleRate) * targetSampleRate)
+                                                       : sourceSampleRate - passFrequency;
+      assert(SineAmplitude(resampledFrames, aliasFrequency, targetSampleRate) < amplitude / 1000);
+    }
+  }
+}
+
+void TestADPCMParallel()
+{
+  constexpr uint64_t framesCount = 1234567;
+
+  for (const uint32_t channels : {1u, 2u})
+  {
+    const auto blockAlign = 0x400 * channels;
+    const auto samplesPerBlock = ADPCMSamplesPerBlock(blockAlign, channels);
+    const auto blocksCount = (framesCount + samplesPerBlock - 1) / samplesPerBlock;
+
+    const auto frames = GenerateTestFrames(framesCount, channels, channels);
+
+    std::vector<char> serialData(blocksCount * blockAlign);
+    std::vector<int16_t> serialReconstructed(frames.size());
+    uint64_t serialSize = 0;
+    for (uint64_t block = 0; block < blocksCount; ++block)
+    {
+      const auto firstFrame = block * samplesPerBlock;
+      serialSize += ADPCMEncodeBlock(frames.data() + firstFrame * channels, static_cast<uint32_t>(std::min<uint64_t>(samplesPerBlock, framesCount - firstFrame)),
+                                     channels, serialData.data() + block * blockAlign, serialReconstructed.data() + firstFrame * channels);
+    }
+    serialData.resize(serialSize);
+
+    std::vector<char> parallelData(blocksCount * blockAlign);
+    std::vector<int16_t> parallelReconstructed(frames.size());
+    parallelData.resize(ADPCMEncodeBlocksParallel(frames.data(), framesCount, channels, blockAlign, parallelData.data(), parallelReconstructed.data()));
+    assert(parallelData == serialData);
+    assert(parallelReconstructed == serialReconstructed);
+
+    std::vector<char> blocksData(blocksCount * blockAlign);
+    std::vector<int16_t> blocksReconstructed(frames.size());
+    blocksData.resize(ADPCMEncodeBlocks(frames.data(), framesCount, channels, blockAlign, blocksData.data(), blocksReconstructed.data()));
+    assert(blocksData == serialData);
+    assert(blocksReconstructed == serialReconstructed);
+
+    std::vector<int16_t> serialFrames(frames.size());
+    std::vector<int16_t> parallelFrames(frames.size());
+    [[maybe_unused]] const auto serialFramesCount = ADPCMDecodeBlocks(serialData, blockAlign, channels, serialFrames.data(), framesCount);
+    [[maybe_unused]] const auto parallelFramesCount = ADPCMDecodeBlocksParallel(parallelData, blockAlign, channels, parallelFrames.data(), framesCount);
+    assert(serialFramesCount == framesCount);
+    assert(parallelFramesCount == framesCount);
+    assert(parallelFrames == serialFrames);
+    assert(parallelFrames == serialReconstructed);
+  }
+}
+
+// Files are transcoded inside worker pools, each worker has to get same output as when transcoding the files one by one.
+void TestTranscodeConcurrent()
+{
+  constexpr uint64_t framesCount = 250007;
+  constexpr size_t filesCount = 16;
+
+  struct TranscodeJob
+  {
+    AudioDataInfo record{};
+    std::vector<char> data;
+    TranscodeFormat targetFormat;
+    std::vector<char> output;
+    AudioDataInfo outputRecord{};
+  };
+
+  std::vector<TranscodeJob> jobs(filesCount);
+  for (size_t file = 0; file < filesCount; ++file)
+  {
+    const auto channels = static_cast<uint16_t>(1 + file % 2);
+    const auto frames = GenerateTestFrames(framesCount + file * 1017, channels, static_cast<uint32_t>(31 + file));
+    const auto pcms16Record = PCMS16TestRecord(22050, channels, frames.size());
+
+    auto &job = jobs[file];
+    job.record = pcms16Record;
+    job.data.assign(AsBytes(frames).begin(), AsBytes(frames).end());
+
+    // NOTE - half of the inputs is IMA ADPCM, so both block reader and block writer run concurrently
+    if (file % 4 >= 2)
+    {
+      std::vector<char> adpcmData;
+      [[maybe_unused]] const auto adpcmTranscoded = TranscodeSoundData(pcms16Record, AsBytes(frames), {AudioDataFormat::IMA_ADPCM, 22050, channels},
+                                                                       adpcmData, job.record);
+      assert(adpcmTranscoded);
+      job.data = std::move(adpcmData);
+    }
+
+    job.targetFormat = {file % 3 == 0 ? AudioDataFormat::PCM_S16 : AudioDataFormat::IMA_ADPCM, file % 2 == 0 ? 22050u : 44100u,
+                        static_cast<uint16_t>(1 + file / 2 % 2)};
+    [[maybe_unused]] const auto transcoded = TranscodeSoundData(job.record, job.data, job.targetFormat, job.output, job.outputRecord);
+    assert(transcoded);
+  }
+
+  for (uint32_t pass = 0; pass < 4; ++pass)
+  {
+    std::atomic_bool mismatch = false;
+    std::for_each(std::execution::par, jobs.begin(), jobs.end(), [&mismatch](const TranscodeJob &job) {
+      std::vector<char> output;
+      AudioDataInfo outputRecord{};
+      const auto transcoded = TranscodeSoundData(job.record, job.data, job.targetFormat, output, outputRecord);
+      if (!transcoded || output != job.output || !(outputRecord == job.outputRecord))
+        mismatch = true;
+
+      if (PCMS16SoundDataXXH3(outputRecord, output) != job.outputRecord.dataXXH3)
+        mismatch = true;
+    });
+    assert(!mismatch);
+  }
+}
+
+void TestRemixKernels()
+{
+  constexpr size_t framesCount = 1021;
+
+  std::mt19937 random(47);
+  std::vector<int16_t> stereoFrames(framesCount * 2);
+  ranges::generate(stereoFrames, [&random] { return static_cast<int16_t>(random()); });
+
+  std::vector<int16_t> monoFrames(stereoFrames);
+  PCMS16RemixChannels(monoFrames.data(), framesCount, 2, 1);
+  for (size_t frame = 0; frame < framesCount; ++frame)
+    assert(monoFrames[frame] == ((stereoFrames[frame * 2] + stereoFrames[frame * 2 + 1] + 1) >> 1));
+
+  std::vector<int16_t> upmixedFrames(monoFrames);
+  PCMS16RemixChannels(upmixedFrames.data(), framesCount, 1, 2);
+  for (size_t frame = 0; frame < framesCount; ++frame)
+  {
+    assert(upmixedFrames[frame * 2] == monoFrames[frame]);
+    assert(upmixedFrames[frame * 2 + 1] == monoFrames[frame]);
+  }
+
+  for (const uint16_t channels : {1, 2, 3})
+  {
+    std::vector<std::vector<float>> planarFrames(channels, std::vector<float>(framesCount));
+    std::vector<float *> planarOutputs;
+    std::vector<const float *> planarInputs;
+    for (auto &channelFrames : planarFrames)
+    {
+      planarOutputs.emplace_back(channelFrames.data());
+      planarInputs.emplace_back(channelFrames.data());
+    }
+
+    const std::span<const int16_t> interleavedFrames(stereoFrames.data(), framesCount / channels * channels);
+    PCMS16DeinterleaveToFloat(interleavedFrames.data(), framesCount / channels, channels, planarOutputs.data());
+    for (size_t sample = 0; sample < interleavedFrames.size(); ++sample)
+      assert(planarFrames[sample % channels][sample / channels] == static_cast<float>(interleavedFrames[sample]));
+
+    planarFrames[0][0] = 40000.4f;
+    planarFrames[0][1] = -40000.6f;
+    planarFrames[0][2] = 2.5f;
+
+    std::vector<int16_t> roundTripFrames(interleavedFrames.size());
+    PCMS16InterleaveFromFloat(planarInputs.data(), framesCount / channels, channels, roundTripFrames.data());
+    assert(roundTripFrames[0] == 32767);
+    assert(roundTripFrames[channels] == -32768);
+    assert(roundTripFrames[channels * 2] == 2);
+    assert(std::equal(roundTripFrames.begin() + channels * 3, roundTripFrames.end(), interleavedFrames.begin() + channels * 3));
+  }
+}
+
+void TestSplitInterleavedBlocks()
+{
+  std::mt19937 random(53);
+  for (const auto& [primaryBlockSize, secondaryBlockSize] : {std::pair<size_t, size_t>{2, 2}, {4, 2}, {2, 4}, {4, 4}, {6, 2}})
+  {
+    for (const size_t blocksCount : {0, 1, 7, 48, 1021})
+    {
+      const auto primarySize = blocksCount * primaryBlockSize + (random() % 3) * primaryBlockSize;
+      const auto secondarySize = blocksCount * secondaryBlockSize + (random() % 3) * secondaryBlockSize;
+
+      std::vector<char> input(primarySize + secondarySize);
+      ranges::generate(input, [&random] { return static_cast<char>(random()); });
+
+      std::vector<char> expectedPrimary;
+      std::vector<char> expectedSecondary;
+      for (size_t offset = 0; offset < input.size();)
+      {
+        const auto primaryCopySize = std::min(primaryBlockSize, primarySize - expectedPrimary.size());
+        expectedPrimary.insert(expectedPrimary.end(), input.begin() + offset, input.begin() + offset + primaryCopySize);
+        offset += primaryCopySize;
+
+        const auto secondaryCopySize = std::min(secondaryBlockSize, secondarySize - expectedSecondary.size());
+        expectedSecondary.insert(expectedSecondary.end(), input.begin() + offset, input.begin() + offset + secondaryCopySize);
+        offset += secondaryCopySize;
+      }
+
+      std::vector<char> primary(primarySize);
+      std::vector<char> secondary(secondarySize);
+      PCMS16SplitInterleavedBlocks(input.data(), primaryBlockSize, secondaryBlockSize, primary.data(), primary.size(), secondary.data(), secondary.size());
+      assert(primary == expectedPrimary);
+      assert(secondary == expectedSecondary);
+
+      std::vector<char> merged(input.size());
+      PCMS16MergeInterleavedBlocks(primary.data(), primary.size(), secondary.data(), secondary.size(), primaryBlockSize, secondaryBlockSize, merged.data());
+      assert(merged == input);
+    }
+  }
+}
+
+void TestHitman1IndexParser()
+{
+  std::string_view text = "-rw-rw-r--   1 zope       123456 Feb  3 12:34 Speech/Intro/A.wav\r\n"
+                          "-rw-rw-r--   1 zope           42 Nov 21  2000 Speech/B.wav\n\n";
+
+  Hitman1IndexEntry entry;
+  assert(ParseHitman1IndexEntry(text, entry));
+  assert(entry.path == "Speech/Intro/A.wav");
+  assert(entry.dataSize == 123456);
+  assert(entry.lastModifiedDate.GetMonth() == "Feb");
+  assert(entry.lastModifiedDate.day == 3);
+  assert(entry.lastModifiedDate.GetTime() == "12:34");
+
+  assert(ParseHitman1IndexEntry(text, entry));
+  assert(entry.path == "Speech/B.wav");
+  assert(entry.dataSize == 42);
+  assert(entry.lastModifiedDate.GetMonth() == "Nov");
+  assert(entry.lastModifiedDate.day == 21);
+  assert(entry.lastModifiedDate.GetTime() == "2000");
+
+  assert(!ParseHitman1IndexEntry(text, entry));
+  assert(text.empty());
+
+  for (std::string_view malformedText : {"-rw-rw-r--   1 zope 12x Feb  3 12:34 A.wav\n", "-rw-rw-r--   1 zope 12 February  3 12:34 A.wav\n",
+                                         "-rw-rw-r--   1 zope 12 Feb  3 12:34\n", "drwxrwxr-x   1 zope 12 Feb  3 12:34 A.wav\n"})
+  {
+    [[maybe_unused]] const auto malformedTextSize = malformedText.size();
+    assert(!ParseHitman1IndexEntry(malformedText, entry));
+    assert(malformedText.size() == malformedTextSize);
+  }
+}
+
+// Builds STR file laid out the same way Hitman4STRFile::Write lays it out, so it must be saved back byte for byte when nothing changes.
+// Data offset of each entry is given as index into data blocks, offsets of headers and names are assigned in entry order.
+std::vector<char> BuildTestSTRFile(const std::vector<std::vector<char>> &dataBlocks, std::vector<STR::v1::Entry> &entries,
+                                   const std::vector<STR::v1::DataHeader> &dataHeaders, const std::vector<std::string_view> &fileNames)
+{
+  std::vector<char> strData(sizeof(STR::v1::Header), 0);
+  const auto appendBytes = [&strData](const void *bytes, const size_t size)
+  {
+    strData.insert(strData.end(), static_cast<const char *>(bytes), static_cast<const char *>(bytes) + size);
+  };
+
+  std::vector<uint64_t> dataBlockOffsets;
+  for (const auto &dataBlock : dataBlocks)
+  {
+    strData.resize((strData.size() + 0xFF) & ~size_t{0xFF}, 0);
+    dataBlockOffsets.emplace_back(strData.size());
+    appendBytes(dataBlock.data(), dataBlock.size());
+  }
+  strData.resize((strData.size() + 0xFF) & ~size_t{0xFF}, 0);
+
+  for (uint32_t i = 0; i < entries.size(); ++i)
+  {
+    entries[i].id = i;
+    entries[i].dataOffset = dataBlockOffsets[entries[i].dataOffset];
+    entries[i].dataHeaderOffset = strData.size();
+    appendBytes(&dataHeaders[i], entries[i].dataHeaderSize);
+  }
+
+  for (uint32_t i = 0; i < entries.size(); ++i)
+  {
+    entries[i].fileNameLength = fileNames[i].size();
+    entries[i].fileNameOffset = strData.size();
+    appendBytes(fileNames[i].data(), fileNames[i].size());
+    strData.emplace_back('\0');
+  }
+
+  STR::v1::Header header = {};
+  header.dataBeginOffset = static_cast<uint32_t>(dataBlockOffsets.front());
+  header.offsetToEntryTable = static_cast<uint32_t>(strData.size());
+  header.entriesCount = static_cast<uint32_t>(entries.size());
+  std::memcpy(strData.data(), &header, sizeof(STR::v1::Header));
+
+  appendBytes(entries.data(), entries.size() * sizeof(STR::v1::Entry));
+  return strData;
+}
+
+std::vector<char> GenerateTestBytes(const size_t size, std::mt19937 &random)
+{
+  std::vector<char> bytes(size);
+  ranges::generate(bytes, [&random] { return static_cast<char>(random() % 255 + 1); });
+  return bytes;
+}
+
+// LIP segment starts with its magic and ends with block of zeroes, which is how segments are found when loading.
+std::vector<char> GenerateTestLIPSegment(std::mt19937 &random)
+{
+  auto lipSegment = GenerateTestBytes(0x1000, random);
+  static constexpr uint32_t lipMagic = 0x2050494C;
+  std::memcpy(lipSegment.data(), &lipMagic, sizeof(lipMagic));
+  std::fill(lipSegment.end() - 0x0400, lipSegment.end(), 0);
+  return lipSegment;
+}
+
+STR::v1::DataHeader PCMS16TestSTRDataHeader(const uint32_t sampleRate, const uint16_t channels, const size_t samplesCount)
+{
+  STR::v1::DataHeader dataHeader = {};
+  dataHeader.FromBaseDataInfo(PCMS16TestRecord(sampleRate, channels, samplesCount));
+  assert(dataHeader.samplesCount == samplesCount);
+  return dataHeader;
+}
+
+void TestHitman4STRRoundTrip()
+{
+  std::mt19937 random(59);
+
+  const auto plainData = GenerateTestBytes(0x1234, random);
+
+  const auto singleLIPData = GenerateTestBytes(0x0FFE, random);
+  const auto singleLIPSegment = GenerateTestLIPSegment(random);
+
+  const auto multiLIPData = GenerateTestBytes(0x5234, random);
+  std::vector<char> multiLIPSegments;
+  std::vector<char> multiLIPBlock;
+  for (size_t segment = 0; segment < 3; ++segment)
+  {
+    const auto lipSegment = GenerateTestLIPSegment(random);
+    multiLIPSegments.insert(multiLIPSegments.end(), lipSegment.begin(), lipSegment.end());
+    multiLIPBlock.insert(multiLIPBlock.end(), lipSegment.begin(), lipSegment.end());
+
+    const auto dataEnd = segment == 2 ? multiLIPData.size() : (segment + 1) * 0x2000;
+    multiLIPBlock.insert(multiLIPBlock.end(), multiLIPData.begin() + segment * 0x2000, multiLIPData.begin() + dataEnd);
+  }
+
+  std::vector<char> singleLIPBlock = singleLIPSegment;
+  singleLIPBlock.insert(singleLIPBlock.end(), singleLIPData.begin(), singleLIPData.end());
+
+  const auto aliasedSub1Data = GenerateTestBytes(0x1000, random);
+  const auto aliasedSub2Data = GenerateTestBytes(0x0800, random);
+  std::vector<char> aliasedBlock(aliasedSub1Data.size() + aliasedSub2Data.size());
+  PCMS16MergeInterleavedBlocks(aliasedSub1Data.data(), aliasedSub1Data.size(), aliasedSub2Data.data(), aliasedSub2Data.size(), 4, 2, aliasedBlock.data());
+
+  STR::v1::DataHeader masterDataHeader = {};
+  masterDataHeader.format = STR::v1::DataFormat::DISTANCE_BASED_MASTER;
+
+  // NOTE - stored data size of aliased master is not sum of its sub-records, it must be kept when they do not change
+  std::vector<STR::v1::Entry> entries(6);
+  entries[0].dataOffset = 0;
+  entries[0].dataSize = plainData.size();
+  entries[0].dataHeaderSize = 24;
+  entries[1].dataOffset = 1;
+  entries[1].dataSize = singleLIPData.size();
+  entries[1].dataHeaderSize = 24;
+  entries[1].hasLIP = true;
+  entries[2].dataOffset = 2;
+  entries[2].dataSize = multiLIPData.size();
+  entries[2].dataHeaderSize = 24;
+  entries[2].hasLIP = true;
+  entries[3].dataOffset = 3;
+  entries[3].dataSize = aliasedBlock.size() + 0x10;
+  entries[3].dataHeaderSize = 0x18;
+  entries[4].dataOffset = 3;
+  entries[4].dataSize = aliasedSub1Data.size();
+  entries[4].dataHeaderSize = 24;
+  entries[4].distanceBasedRecordOrder = 1;
+  entries[5].dataOffset = 3;
+  entries[5].dataSize = aliasedSub2Data.size();
+  entries[5].dataHeaderSize = 24;
+  entries[5].distanceBasedRecordOrder = 2;
+
+  const auto strData = BuildTestSTRFile({plainData, singleLIPBlock, multiLIPBlock, aliasedBlock}, entries,
+                                        {PCMS16TestSTRDataHeader(22050, 1, plainData.size() / sizeof(int16_t)),
+                                         PCMS16TestSTRDataHeader(22050, 1, singleLIPData.size() / sizeof(int16_t)),
+                                         PCMS16TestSTRDataHeader(22050, 1, multiLIPData.size() / sizeof(int16_t)), masterDataHeader,
+                                         PCMS16TestSTRDataHeader(22050, 1, aliasedSub1Data.size() / sizeof(int16_t)),
+                                         PCMS16TestSTRDataHeader(11025, 1, aliasedSub2Data.size() / sizeof(int16_t))},
+                                        {"A.wav", "B.wav", "C.wav", "D", "D1.wav", "D2.wav"});
+
+  const auto checkLoaded = [](const Hitman4ArchiveDialog &dialog, const std::vector<char> &expectedPlainData, const std::vector<char> &expectedSingleLIPData,
+                              const std::vector<char> &expectedSingleLIPSegment, const std::vector<char> &expectedMultiLIPData,
+                              const std::vector<char> &expectedMultiLIPSegments, const std::vector<char> &expectedSub1Data,
+                              const std::vector<char> &expectedSub2Data)
+  {
+    assert(dialog.fileMap.size() == 5);
+    assert(dialog.fileMap.at(StringView8CI("Streams\\A.wav")).data == expectedPlainData);
+    assert(dialog.fileMap.at(StringView8CI("Streams\\B.wav")).data == expectedSingleLIPData);
+    assert(dialog.fileMap.at(StringView8CI("Streams\\C.wav")).data == expectedMultiLIPData);
+    assert(dialog.fileMap.at(StringView8CI("Streams\\D1.wav")).data == expectedSub1Data);
+    assert(dialog.fileMap.at(StringView8CI("Streams\\D2.wav")).data == expectedSub2Data);
+
+    assert(dialog.streamsWAV.GetLIPData(0).empty());
+    assert(dialog.streamsWAV.GetLIPData(1) == expectedSingleLIPSegment);
+    assert(dialog.streamsWAV.GetLIPData(2) == expectedMultiLIPSegments);
+    assert(dialog.streamsWAV.GetLIPData(4).empty());
+    assert(dialog.streamsWAV.GetLIPData(5).empty());
+  };
+
+  const String8CI savePath(std::filesystem::temp_directory_path() / "G1ATTestStreams.str");
+
+  Hitman4ArchiveDialog dialog;
+  [[maybe_unused]] const auto loaded = dialog.streamsWAV.Load(dialog, strData);
+  assert(loaded);
+  checkLoaded(dialog, plainData, singleLIPData, singleLIPSegment, multiLIPData, multiLIPSegments, aliasedSub1Data, aliasedSub2Data);
+
+  [[maybe_unused]] const auto saved = dialog.streamsWAV.Save(savePath);
+  assert(saved);
+  assert(ReadWholeBinaryFile(savePath) == strData);
+
+  Hitman4ArchiveDialog reloadedDialog;
+  [[maybe_unused]] const auto reloaded = reloadedDialog.streamsWAV.Load(reloadedDialog, savePath);
+  assert(reloaded);
+  checkLoaded(reloadedDialog, plainData, singleLIPData, singleLIPSegment, multiLIPData, multiLIPSegments, aliasedSub1Data, aliasedSub2Data);
+  assert(reloadedDialog.streamsWAV.recordTable[3].dataSize == aliasedBlock.size() + 0x10);
+
+  // NOTE - changed files get their WAV headers rebuilt, aliased master gets data size of its changed sub-records
+  auto &plainFile = dialog.fileMap.at(StringView8CI("Streams\\A.wav"));
+  plainFile.data.resize(0x1000);
+  plainFile.archiveRecord = HashedSoundRecord(PCMS16TestRecord(44100, 1, plainFile.data.size() / sizeof(int16_t)), {plainFile.data.data(), plainFile.data.size()});
+
+  auto &aliasedSub1File = dialog.fileMap.at(StringView8CI("Streams\\D1.wav"));
+  aliasedSub1File.data.resize(0x0800);
+  aliasedSub1File.archiveRecord = HashedSoundRecord(PCMS16TestRecord(22050, 1, aliasedSub1File.data.size() / sizeof(int16_t)),
+                                                    {aliasedSub1File.data.data(), aliasedSub1File.data.size()});
+
+  auto &aliasedSub2File = dialog.fileMap.at(StringView8CI("Streams\\D2.wav"));
+  aliasedSub2File.data.resize(0x0400);
+  aliasedSub2File.archiveRecord = HashedSoundRecord(PCMS16TestRecord(11025, 1, aliasedSub2File.data.size() / sizeof(int16_t)),
+                                                    {aliasedSub2File.data.data(), aliasedSub2File.data.size()});
+
+  [[maybe_unused]] const auto savedChanged = dialog.streamsWAV.Save(savePath);
+  assert(savedChanged);
+
+  Hitman4ArchiveDialog changedDialog;
+  [[maybe_unused]] const auto reloadedChanged = changedDialog.streamsWAV.Load(changedDialog, savePath);
+  assert(reloadedChanged);
+  checkLoaded(changedDialog, plainFile.data, singleLIPData, singleLIPSegment, multiLIPData, multiLIPSegments, aliasedSub1File.data, aliasedSub2File.data);
+  assert(changedDialog.streamsWAV.wavHeaderTable[0].sampleRate == 44100);
+  assert(changedDialog.streamsWAV.wavHeaderTable[0].samplesCount == plainFile.data.size() / sizeof(int16_t));
+  assert(changedDialog.streamsWAV.wavHeaderTable[4].samplesCount == aliasedSub1File.data.size() / sizeof(int16_t));
+  assert(changedDialog.streamsWAV.wavHeaderTable[5].samplesCount == aliasedSub2File.data.size() / sizeof(int16_t));
+  assert(changedDialog.streamsWAV.recordTable[3].dataSize == aliasedSub1File.data.size() + aliasedSub2File.data.size());
+
+  // NOTE - imports into aliased sub-records are converted to PCM S16 of the sub-record even when options say otherwise,
+  //        import is skipped when it cannot be converted, here because of original record of other format
+  auto options = Options::Get();
+  options.common.disableWarnings = true;
+  options.common.directImport = true;
+  options.common.fixChannels = false;
+  options.common.fixSampleRate = false;
+
+  const auto importDirectory = std::filesystem::temp_directory_path() / "G1ATTestStreamsImport";
+  create_directories(importDirectory / "Streams");
+
+  const auto importFrames = GenerateTestFrames(0x1000, 2, 61);
+  const auto importHeader = PCMS16Header(PCMS16TestRecord(44100, 2, importFrames.size()));
+  std::vector<char> importData(sizeof(PCMS16_Header));
+  std::memcpy(importData.data(), &importHeader, sizeof(PCMS16_Header));
+  const auto importFramesBytes = AsBytes(importFrames);
+  importData.insert(importData.end(), importFramesBytes.begin(), importFramesBytes.end());
+  for (const auto *importFileName : {"D1.wav", "D2.wav"})
+    std::ofstream(importDirectory / "Streams" / importFileName, std::ios::binary | std::ios::trunc).write(importData.data(), static_cast<int64_t>(importData.size()));
+
+  auto &importedSub1File = changedDialog.fileMap.at(StringView8CI("Streams\\D1.wav"));
+  auto &importedSub2File = changedDialog.fileMap.at(StringView8CI("Streams\\D2.wav"));
+  importedSub2File.originalRecord = PCMS16TestRecord(44100, 2, importFrames.size());
+  importedSub2File.originalRecord.dataXXH3 = 1;
+  const auto importedSub2Record = importedSub2File.archiveRecord;
+
+  const String8CI importFolderPath(importDirectory);
+  [[maybe_unused]] const auto importedSub1 = changedDialog.ImportSingle(importFolderPath, String8CI(importDirectory / "Streams" / "D1.wav"), options);
+  assert(importedSub1);
+  [[maybe_unused]] const auto importedSub2 = changedDialog.ImportSingle(importFolderPath, String8CI(importDirectory / "Streams" / "D2.wav"), options);
+  assert(!importedSub2);
+  assert(!importedSub2File.pendingImport);
+  assert(importedSub2File.archiveRecord == importedSub2Record);
+  assert(importedSub2File.data == aliasedSub2File.data);
+
+  [[maybe_unused]] const auto resolved = changedDialog.ResolvePendingImports(options);
+  assert(resolved);
+  assert(importedSub1File.archiveRecord.format == AudioDataFormat::PCM_S16);
+  assert(importedSub1File.archiveRecord.sampleRate == 22050);
+  assert(importedSub1File.archiveRecord.channels == 1);
+
+  [[maybe_unused]] const auto savedImported = changedDialog.streamsWAV.Save(savePath);
+  assert(savedImported);
+
+  Hitman4ArchiveDialog importedDialog;
+  [[maybe_unused]] const auto reloadedImported = importedDialog.streamsWAV.Load(importedDialog, savePath);
+  assert(reloadedImported);
+  checkLoaded(importedDialog, plainFile.data, singleLIPData, singleLIPSegment, multiLIPData, multiLIPSegments, importedSub1File.data, aliasedSub2File.data);
+  assert(importedDialog.streamsWAV.wavHeaderTable[4].sampleRate == 22050);
+  assert(importedDialog.streamsWAV.wavHeaderTable[4].channels == 1);
+  assert(importedDialog.streamsWAV.wavHeaderTable[4].samplesCount == importedSub1File.data.size() / sizeof(int16_t));
+  assert(importedDialog.streamsWAV.wavHeaderTable[5].sampleRate == 11025);
+
+  std::filesystem::remove_all(importDirectory);
+  std::filesystem::remove(savePath.path());
+}
+
+// Streams entries keep values the library would derive differently, import changes only fields its record changed.
+void TestHitman4WHDStreamsEntry()
+{
+  const auto loadedRecord = PCMS16TestRecord(22050, 1, 0x0400);
+
+  alignas(16) std::array<char, sizeof(WHD::v2::EntryStreams)> streamsEntry{};
+  auto *streamsRecord = reinterpret_cast<WHD::v2::EntryScenes *>(streamsEntry.data());
+  streamsRecord->FromBaseDataInfo(loadedRecord);
+  streamsRecord->fileNameLength = 5;
+  streamsRecord->fileNameOffset = 0x40;
+  streamsRecord->dataInStreams = 1;
+  streamsRecord->dataOffset = 0x1000;
+  streamsRecord->samplesPerBlock = 0xCDCDCDCD;
+  const auto loadedStreamsEntry = streamsEntry;
+
+  Hitman4ArchiveDialog dialog;
+  auto &archiveFile = dialog.GetFile(StringView8CI("Streams\\A.wav"));
+  auto &file = dialog.fileMap.try_emplace(archiveFile.path, Glacier1AudioFile{archiveFile.path, loadedRecord}).first->second;
+  dialog.whdStreamsRecordsMap[archiveFile.path].emplace_back(streamsRecord);
+  dialog.whdStreamsPatchedRecords.try_emplace(archiveFile.path, loadedRecord);
+
+  dialog.UpdateArchiveRecords(file);
+  assert(streamsEntry == loadedStreamsEntry);
+
+  file.archiveRecord = PCMS16TestRecord(22050, 1, 0x0800);
+  dialog.UpdateArchiveRecords(file);
+  assert(streamsRecord->dataSize == file.archiveRecord.dataSize);
+  assert(streamsRecord->samplesPerBlock == 0xCDCDCDCD);
+  assert(streamsRecord->fileNameLength == 5);
+  assert(streamsRecord->fileNameOffset == 0x40);
+  assert(streamsRecord->dataInStreams == 1);
+  assert(streamsRecord->dataOffset == 0x1000);
+
+  file.archiveRecord = loadedRecord;
+  dialog.UpdateArchiveRecords(file);
+  assert(streamsEntry == loadedStreamsEntry);
+}
+
+void TestHitman1RoundTrip()
+{
+  std::mt19937 random(71);
+
+  // NOTE - archive is saved in chunks of 64 entries, entries are spread over several chunks with partial one at the end
+  static constexpr size_t entriesCount = 64 * 2 + 7;
+
+  const auto buildEntry = [&random](const size_t samplesCount, std::vector<char> &entryData)
+  {
+    entryData = GenerateTestBytes(samplesCount * sizeof(int16_t), random);
+
+    const auto header = PCMS16Header(PCMS16TestRecord(22050, 1, samplesCount));
+    std::vector<char> entry(sizeof(PCMS16_Header));
+    std::memcpy(entry.data(), &header, sizeof(PCMS16_Header));
+    entry.insert(entry.end(), entryData.begin(), entryData.end());
+    return entry;
+  };
+
+  std::vector<char> archiveBin;
+  std::string archiveIdx;
+  std::vector<std::vector<char>> entriesData(entriesCount);
+  for (size_t i = 0; i < entriesCount; ++i)
+  {
+    const auto entry = buildEntry(random() % 0x200 + 1, entriesData[i]);
+    archiveBin.insert(archiveBin.end(), entry.begin(), entry.end());
+    archiveIdx += Format("-rw-rw-r--   1 zope {:12d} {} {:2d} {} Speech/Test{:03d}.wav\n", entry.size(), i % 2 ? "Nov" : "Feb", i % 2 ? 21 : 3,
+                         i % 2 ? "2000" : "12:34", i).native();
+  }
+
+  const auto testDirectory = std::filesystem::temp_directory_path() / "G1ATTestHitman1";
+  create_directories(testDirectory);
+
+  std::ofstream(testDirectory / "Input.bin", std::ios::binary | std::ios::trunc).write(archiveBin.data(), static_cast<int64_t>(archiveBin.size()));
+  std::ofstream(testDirectory / "Input.idx", std::ios::trunc).write(archiveIdx.data(), static_cast<int64_t>(archiveIdx.size()));
+
+  const auto options = Options::Get();
+
+  Hitman1ArchiveDialog dialog;
+  [[maybe_unused]] const auto loaded = dialog.LoadImpl(String8CI(testDirectory / "Input.idx"), options);
+  assert(loaded);
+  assert(dialog.indexToKey.size() == entriesCount);
+  for (size_t i = 0; i < entriesCount; ++i)
+    assert(dialog.fileMap.at(dialog.indexToKey[i]).data == entriesData[i]);
+
+  const auto loadedOriginalDataID = dialog.originalDataID;
+
+  [[maybe_unused]] const auto saved = dialog.SaveImpl(String8CI(testDirectory / "Saved.idx"), options);
+  assert(saved);
+  assert(ReadWholeBinaryFile(String8CI(testDirectory / "Saved.bin")) == archiveBin);
+  assert(ReadWholeBinaryFile(String8CI(testDirectory / "Saved.idx")) == ReadWholeBinaryFile(String8CI(testDirectory / "Input.idx")));
+
+  // NOTE - entry in the middle of a chunk grows, so offsets of all entries after it change, including ones in later chunks
+  static constexpr size_t changedEntryIndex = 64 + 5;
+  const auto changedEntry = buildEntry(0x300, entriesData[changedEntryIndex]);
+  [[maybe_unused]] const auto imported = dialog.ImportSingleHitmanFile(dialog.fileMap.at(dialog.indexToKey[changedEntryIndex]), changedEntry, false, options);
+  assert(imported);
+
+  [[maybe_unused]] const auto savedChanged = dialog.SaveImpl(String8CI(testDirectory / "Changed.idx"), options);
+  assert(savedChanged);
+
+  Hitman1ArchiveDialog changedDialog;
+  [[maybe_unused]] const auto loadedChanged = changedDialog.LoadImpl(String8CI(testDirectory / "Changed.idx"), options);
+  assert(loadedChanged);
+  assert(changedDialog.indexToKey.size() == entriesCount);
+  for (size_t i = 0; i < entriesCount; ++i)
+  {
+    assert(changedDialog.indexToKey[i] == dialog.indexToKey[i]);
+    assert(changedDialog.fileMap.at(changedDialog.indexToKey[i]).data == entriesData[i]);
+    assert(changedDialog.lastModifiedDatesMap.at(changedDialog.indexToKey[i]).GetTime() == (i % 2 ? "2000" : "12:34"));
+  }
+
+  // NOTE - records of original data are cached for every loaded or saved archive, ones of test archives are removed with them
+  for (const auto originalDataID : {loadedOriginalDataID, dialog.originalDataID})
+  {
+    auto dataPathString = dialog.originalDataPathPrefix;
+    dataPathString += Format("{:16X}", originalDataID);
+    std::filesystem::remove(dataPathString.path());
+  }
+
+  std::filesystem::remove_all(testDirectory);
+}
+
+Hitman23WHDRecord Hitman23TestWHDRecord(const size_t dataOffset, const size_t dataSize, const uint16_t dataInStreams)
+{
+  Hitman23WHDRecord whdRecord;
+  whdRecord.FromHitmanSoundRecord(PCMS16TestRecord(22050, 1, dataSize / sizeof(int16_t)));
+  whdRecord.dataInStreams = dataInStreams;
+  whdRecord.dataOffset = static_cast<uint32_t>(dataOffset);
+  return whdRecord;
+}
+
+void TestHitman23WAVLayout()
+{
+  std::mt19937 random(61);
+
+  const auto firstData = GenerateTestBytes(0x20, random);
+  const auto secondData = GenerateTestBytes(0x10, random);
+
+  // NOTE - header of mission WAV is kept as data between files, Layout patches size stored in it
+  Hitman23WAVHeader wavHeader;
+  wavHeader.fileSizeWithHeader = static_cast<uint32_t>(sizeof(Hitman23WAVHeader) + firstData.size() + secondData.size());
+
+  std::vector<char> wavData(sizeof(Hitman23WAVHeader));
+  std::memcpy(wavData.data(), &wavHeader, sizeof(Hitman23WAVHeader));
+  wavData.insert(wavData.end(), firstData.begin(), firstData.end());
+  wavData.insert(wavData.end(), secondData.begin(), secondData.end());
+
+  const std::array<String8CI, 2> filePaths{String8CI("Scene\\A.wav"), String8CI("Scene\\B.wav")};
+  std::array<Hitman23WHDRecord, 2> whdRecords{Hitman23TestWHDRecord(sizeof(Hitman23WAVHeader), firstData.size(), 0),
+                                              Hitman23TestWHDRecord(sizeof(Hitman23WAVHeader) + firstData.size(), secondData.size(), 0)};
+
+  OrderedMap<StringView8CI, Hitman23WHDRecord *> whdRecordsMap;
+  OrderedMap<StringView8CI, Glacier1AudioFile> fileMap;
+  for (size_t i = 0; i < filePaths.size(); ++i)
+  {
+    whdRecordsMap.try_emplace(filePaths[i], &whdRecords[i]);
+    fileMap.try_emplace(filePaths[i], Glacier1AudioFile{filePaths[i], whdRecords[i].ToHitmanSoundRecord()});
+  }
+
+  Hitman23WAVFile wavFile;
+  [[maybe_unused]] const auto loaded = wavFile.Load(wavData, whdRecordsMap, fileMap, true);
+  assert(loaded);
+
+  wavFile.Layout();
+  assert(!wavFile.dirty);
+  assert(wavFile.header->fileSizeWithHeader == wavData.size());
+
+  // NOTE - data changed in place keeps all offsets, it is found only by its hash
+  auto &firstFile = fileMap.at(filePaths[0]);
+  std::reverse(firstFile.data.begin(), firstFile.data.end());
+  firstFile.archiveRecord = HashedSoundRecord(firstFile.archiveRecord, {firstFile.data.data(), firstFile.data.size()});
+
+  wavFile.Layout();
+  assert(wavFile.dirty);
+  assert(wavFile.recordMap.at(sizeof(Hitman23WAVHeader)).newOffset == sizeof(Hitman23WAVHeader));
+
+  wavFile.CommitLayout();
+  assert(!wavFile.dirty);
+
+  wavFile.Layout();
+  assert(!wavFile.dirty);
+
+  // NOTE - resized data moves files after it and changes size of the whole file
+  firstFile.data.resize(0x30, 0);
+  firstFile.archiveRecord = HashedSoundRecord(PCMS16TestRecord(22050, 1, firstFile.data.size() / sizeof(int16_t)), {firstFile.data.data(), firstFile.data.size()});
+
+  [[maybe_unused]] const auto secondOffset = static_cast<uint32_t>(sizeof(Hitman23WAVHeader) + firstFile.data.size());
+  wavFile.Layout();
+  assert(wavFile.dirty);
+  assert(wavFile.recordMap.at(static_cast<uint32_t>(sizeof(Hitman23WAVHeader) + firstData.size())).newOffset == secondOffset);
+  assert(wavFile.header->fileSizeWithHeader == secondOffset + secondData.size());
+
+  std::vector<char> expectedWAVData(sizeof(Hitman23WAVHeader));
+  std::memcpy(expectedWAVData.data(), wavFile.header, sizeof(Hitman23WAVHeader));
+  expectedWAVData.insert(expectedWAVData.end(), firstFile.data.begin(), firstFile.data.end());
+  expectedWAVData.insert(expectedWAVData.end(), secondData.begin(), secondData.end());
+
+  const String8CI savePath(std::filesystem::temp_directory_path() / "G1ATTestScene.wav");
+  [[maybe_unused]] const auto written = wavFile.Write(savePath);
+  assert(written);
+  assert(ReadWholeBinaryFile(savePath) == expectedWAVData);
+
+  wavFile.CommitLayout();
+  assert(!wavFile.dirty);
+  assert(wavFile.recordMap.find(secondOffset) != wavFile.recordMap.end());
+
+  wavFile.Layout();
+  assert(!wavFile.dirty);
+
+  std::filesystem::remove(savePath.path());
+}
+
+void TestHitman23SharedData()
+{
+  std::mt19937 random(67);
+
+  const auto sharedData = GenerateTestBytes(0x20, random);
+  const auto nextData = GenerateTestBytes(0x10, random);
+
+  std::vector<char> wavData = sharedData;
+  wavData.insert(wavData.end(), nextData.begin(), nextData.end());
+
+  // NOTE - first file owns the shared data, second one shares it, last one follows it
+  const std::array<String8CI, 3> filePaths{String8CI("Streams\\A.wav"), String8CI("Streams\\S.wav"), String8CI("Streams\\Z.wav")};
+  std::array<Hitman23WHDRecord, 3> whdRecords{Hitman23TestWHDRecord(0, sharedData.size(), 0x8000), Hitman23TestWHDRecord(0, sharedData.size(), 0x8000),
+                                              Hitman23TestWHDRecord(sharedData.size(), nextData.size(), 0x8000)};
+
+  OrderedMap<StringView8CI, Hitman23WHDRecord *> whdRecordsMap;
+  OrderedMap<StringView8CI, Glacier1AudioFile> fileMap;
+  for (size_t i = 0; i < filePaths.size(); ++i)
+  {
+    whdRecordsMap.try_emplace(filePaths[i], &whdRecords[i]);
+    fileMap.try_emplace(filePaths[i], Glacier1AudioFile{filePaths[i], whdRecords[i].ToHitmanSoundRecord()});
+  }
+
+  Hitman23WAVFile streamsWAV;
+  [[maybe_unused]] const auto loaded = streamsWAV.Load(wavData, whdRecordsMap, fileMap, false);
+  assert(loaded);
+  assert(streamsWAV.recordMap.size() == 2);
+  assert(streamsWAV.recordMap.at(0).sharedData.size() == 1);
+
+  streamsWAV.Layout();
+  assert(!streamsWAV.dirty);
+  assert(streamsWAV.recordMap.at(0).GetNewOffset(filePaths[1]) == 0);
+
+  // NOTE - every scene refers to the shared file by its own record, all of them have to be patched
+  std::array<Hitman23WHDRecord, 2> sharerWHDRecords{whdRecords[1], whdRecords[1]};
+  std::array<Hitman23WHDFile, 2> whdFiles;
+  whdFiles[0].recordMap.try_emplace(filePaths[0], &whdRecords[0]);
+  whdFiles[0].recordMap.try_emplace(filePaths[1], &sharerWHDRecords[0]);
+  whdFiles[1].recordMap.try_emplace(filePaths[1], &sharerWHDRecords[1]);
+  whdFiles[1].recordMap.try_emplace(filePaths[2], &whdRecords[2]);
+
+  // NOTE - sharer whose data diverged from data of the owner is stored after it, moving following data
+  auto &sharerFile = fileMap.at(filePaths[1]);
+  std::reverse(sharerFile.data.begin(), sharerFile.data.end());
+  sharerFile.archiveRecord = HashedSoundRecord(sharerFile.archiveRecord, {sharerFile.data.data(), sharerFile.data.size()});
+
+  streamsWAV.Layout();
+  assert(streamsWAV.dirty);
+  assert(streamsWAV.recordMap.at(0).GetNewOffset(filePaths[0]) == 0);
+  assert(streamsWAV.recordMap.at(0).GetNewOffset(filePaths[1]) == sharedData.size());
+  assert(streamsWAV.recordMap.at(static_cast<uint32_t>(sharedData.size())).newOffset == sharedData.size() * 2);
+
+  Hitman23WAVFile missionWAV;
+  for (size_t i = 0; i < whdFiles.size(); ++i)
+  {
+    const String8CI whdSavePath(std::filesystem::temp_directory_path() / ("G1ATTestScene" + std::to_string(i) + ".whd"));
+    [[maybe_unused]] const auto whdSaved = whdFiles[i].Save(streamsWAV, missionWAV, whdSavePath);
+    assert(whdSaved);
+    std::filesystem::remove(whdSavePath.path());
+  }
+
+  assert(whdRecords[0].dataOffset == 0);
+  assert(sharerWHDRecords[0].dataOffset == sharedData.size());
+  assert(sharerWHDRecords[1].dataOffset == sharedData.size());
+  assert(whdRecords[2].dataOffset == sharedData.size() * 2);
+
+  std::vector<char> expectedWAVData = sharedData;
+  expectedWAVData.insert(expectedWAVData.end(), sharerFile.data.begin(), sharerFile.data.end());
+  expectedWAVData.insert(expectedWAVData.end(), nextData.begin(), nextData.end());
+
+  const String8CI savePath(std::filesystem::temp_directory_path() / "G1ATTestStreams.wav");
+  [[maybe_unused]] const auto written = streamsWAV.Write(savePath);
+  assert(written);
+  assert(ReadWholeBinaryFile(savePath) == expectedWAVData);
+
+  // NOTE - once saved separately, former sharer becomes record of its own
+  streamsWAV.CommitLayout();
+  assert(streamsWAV.recordMap.size() == 3);
+  assert(streamsWAV.recordMap.at(0).sharedData.empty());
+  assert(streamsWAV.recordMap.at(static_cast<uint32_t>(sharedData.size())).GetNewOffset(filePaths[1]) == sharedData.size());
+
+  streamsWAV.Layout();
+  assert(!streamsWAV.dirty);
+
+  std::filesystem::remove(savePath.path());
+}
+
+#ifdef G1AT_BUILD_BENCHMARKS
+
+void BenchmarkADPCMDecoder()
+{
+  constexpr uint32_t blocksCount = 1023;
+  constexpr uint32_t benchmarkRuns = 32;
+
+  for (const uint32_t channels : {1u, 2u})
+  {
+    const auto blockAlign = 0x400 * channels;
+    const auto samplesPerBlock = ADPCMSamplesPerBlock(blockAlign, channels);
+
+    std::mt19937 random(channels);
+    std::vector<char> adpcmData(blocksCount * blockAlign);
+    ranges::generate(adpcmData, [&random] { return static_cast<char>(random()); });
+
+    const auto maxFrames = static_cast<uint64_t>(blocksCount) * samplesPerBlock;
+    std::vector<int16_t> frames(maxFrames * channels);
+    for (const auto simdLevel : {SIMDLevel::SCALAR, SIMDLevel::SSE41, SIMDLevel::AVX2, SIMDLevel::NEON})
+    {
+      if (GetSIMDLevel(simdLevel) != simdLevel)
+        continue;
+
+      const auto benchmarkStart = std::chrono::steady_clock::now();
+      for (uint32_t run = 0; run < benchmarkRuns; ++run)
+        ADPCMDecodeBlocks(adpcmData, blockAlign, channels, frames.data(), maxFrames, simdLevel);
+      const std::chrono::duration<double> benchmarkDuration = std::chrono::steady_clock::now() - benchmarkStart;
+
+      APP_INFO("IMA ADPCM decoder, {} channel(s), SIMD level {}: {:.1f} MiB/s", channels, static_cast<uint32_t>(simdLevel),
+               static_cast<double>(adpcmData.size()) * benchmarkRuns / benchmarkDuration.count() / (1024.0 * 1024.0));
+    }
+  }
+}
+
+void BenchmarkResampler()
+{
+  constexpr uint32_t benchmarkSeconds = 10;
+
+  for (const auto quality : {ResamplerQuality::FAST, ResamplerQuality::BALANCED, ResamplerQuality::HIGH})
+  {
+    for (const auto &[sourceSampleRate, targetSampleRate] : {std::pair<uint32_t, uint32_t>{22050, 44100}, {44100, 22050}, {44100, 48000}})
+    {
+      const auto frames = GenerateTestFrames(sourceSampleRate * benchmarkSeconds, 2, sourceSampleRate);
+      const auto framesCount = frames.size() / 2;
+
+      PCMS16Resampler resampler;
+      std::vector<int16_t> resampledFrames;
+      resampledFrames.reserve(resampler.GetOutputFrames(framesCount) * 2);
+      resampler.Reset(sourceSampleRate, targetSampleRate, 2, quality);
+      const auto resamplerStart = std::chrono::steady_clock::now();
+      resampler.Process(frames, resampledFrames);
+      resampler.Flush(resampledFrames);
+      const std::chrono::duration<double> resamplerDuration = std::chrono::steady_clock::now() - resamplerStart;
+
+      auto libraryHeader = PCMS16Header(PCMS16TestRecord(sourceSampleRate, 2, frames.size()));
+      auto libraryFrames = frames;
+      const auto libraryStart = std::chrono::steady_clock::now();
+      PCMS16ChangeSampleRate(libraryHeader, libraryFrames, targetSampleRate);
+      const std::chrono::duration<double> libraryDuration = std::chrono::steady_clock::now() - libraryStart;
+
+      APP_INFO("Resampler {} Hz -> {} Hz, quality {}: {:.1f} Mframes/s, library: {:.1f} Mframes/s", sourceSampleRate, targetSampleRate,
+               static_cast<uint32_t>(quality), framesCount / resamplerDuration.count() / 1e6, framesCount / libraryDuration.count() / 1e6);
+    }
+  }
+}
+
+#endif
+
 }
 
 void RunTests()
 {
   TestStringImpls();
+  TestADPCMDecoder();
+  TestADPCMDecoderMatchesLibrary();
+  TestADPCMParallel();
+  TestTranscodeConcurrent();
+  TestTranscodePipeline();
+  TestResampler();
+  TestRemixKernels();
+  TestSplitInterleavedBlocks();
+  TestHitman1IndexParser();
+  TestHitman1RoundTrip();
+  TestHitman23WAVLayout();
+  TestHitman23SharedData();
+  TestHitman4STRRoundTrip();
+  TestHitman4WHDStreamsEntry();
+
+#ifdef G1AT_BUILD_BENCHMARKS
+  BenchmarkADPCMDecoder();
+  BenchmarkResampler();
+#endif
 }
 
 #else
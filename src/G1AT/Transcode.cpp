@@ -0,0 +1,449 @@
+//
+// Created by Andrej Redeky.
+// Copyright © 2015-2023 Feldarian Softworks. All rights reserved.
+// SPDX-License-Identifier: EUPL-1.2
+//
+
+#include <Precompiled.hpp>
+
+#include "Transcode.hpp"
+
+#include "ADPCM.hpp"
+#include "Remix.hpp"
+
+namespace
+{
+
+// IMA ADPCM blocks decoded or encoded at once, scratch buffers stay at few MiB per thread.
+// NOTE - blocks of single stream are always handled on calling thread. Transcoding runs inside import, resolve and load
+//        worker pools, and thread waiting on nested parallel loop may pick up another outer task, which would then
+//        reuse the same per-thread scratch buffers while they are still in use.
+constexpr uint32_t adpcmDecodeBatchBlocks = 1024;
+constexpr uint32_t adpcmEncodeBatchBlocks = 512;
+
+class PCMS16BlockWriter
+{
+public:
+  bool Begin(const TranscodeFormat &newFormat, std::vector<char> &newOutput)
+  {
+    format = newFormat;
+    output = &newOutput;
+    outputBegin = newOutput.size();
+    frames = 0;
+
+    auto &scratch = TranscodeScratch::Get();
+    XXH3_64bits_reset(scratch.GetXXH3State());
+
+    switch (format.format)
+    {
+      case AudioDataFormat::PCM_S16: {
+        writeBlock = &PCMS16BlockWriter::WritePCMS16;
+        return true;
+      }
+      case AudioDataFormat::IMA_ADPCM: {
+        if (format.blockAlign == 0)
+          format.blockAlign = static_cast<uint16_t>(0x400 * format.channels);
+
+        samplesPerBlock = ADPCMSamplesPerBlock(format.blockAlign, format.channels);
+        if (samplesPerBlock == 0 || ADPCMBlockAlign(samplesPerBlock, format.channels) != format.blockAlign)
+          return false;
+
+        scratch.pendingFrames.clear();
+        scratch.pendingFrames.reserve(static_cast<size_t>(adpcmEncodeBatchBlocks) * samplesPerBlock * format.channels);
+        scratch.reconstructedFrames.resize(static_cast<size_t>(adpcmEncodeBatchBlocks) * samplesPerBlock * format.channels);
+        writeBlock = &PCMS16BlockWriter::WriteADPCM;
+        return true;
+      }
+      case AudioDataFormat::OGG_VORBIS: {
+        writeBlock = &PCMS16BlockWriter::WriteVorbis;
+        return scratch.vorbisEncoder.Begin(format.channels, format.sampleRate, VorbisQuality(format.vorbisQuality), newOutput);
+      }
+      default: {
+        return false;
+      }
+    }
+  }
+
+  bool Write(const std::span<const int16_t> &input)
+  {
+    frames += input.size() / format.channels;
+
+    return (this->*writeBlock)(input);
+  }
+
+  bool Finish(AudioDataInfo &outputRecord)
+  {
+    auto &scratch = TranscodeScratch::Get();
+
+    const auto dataSize = static_cast<uint32_t>(output->size() - outputBegin);
+    switch (format.format)
+    {
+      case AudioDataFormat::PCM_S16: {
+        AudioDataInfo pcms16Record{};
+        pcms16Record.format = AudioDataFormat::PCM_S16;
+        pcms16Record.sampleRate = format.sampleRate;
+        pcms16Record.channels = format.channels;
+        pcms16Record.bitsPerSample = 16;
+        pcms16Record.blockAlign = static_cast<uint16_t>(format.channels * sizeof(int16_t));
+        pcms16Record.samplesPerBlock = 1;
+        pcms16Record.dataSize = dataSize;
+        pcms16Record.dataSizeUncompressed = dataSize;
+
+        outputRecord = PCMS16SoundRecord(PCMS16Header(pcms16Record), XXH3_64bits_digest(scratch.GetXXH3State()));
+        outputRecord.samplesPerBlock = 1;
+        return true;
+      }
+      case AudioDataFormat::IMA_ADPCM: {
+        if (!scratch.pendingFrames.empty())
+          EncodeADPCMBlocks();
+
+        AudioDataInfo adpcmRecord{};
+        adpcmRecord.format = AudioDataFormat::IMA_ADPCM;
+        adpcmRecord.sampleRate = format.sampleRate;
+        adpcmRecord.channels = format.channels;
+        adpcmRecord.bitsPerSample = 4;
+        adpcmRecord.blockAlign = format.blockAlign;
+        adpcmRecord.samplesPerBlock = static_cast<uint16_t>(samplesPerBlock);
+        adpcmRecord.dataSize = static_cast<uint32_t>(output->size() - outputBegin);
+        adpcmRecord.dataSizeUncompressed = static_cast<uint32_t>(frames * format.channels * sizeof(int16_t));
+        adpcmRecord.dataXXH3 = XXH3_64bits_digest(scratch.GetXXH3State());
+
+        outputRecord = adpcmRecord;
+        return true;
+      }
+      case AudioDataFormat::OGG_VORBIS: {
+        // NOTE - Vorbis output is only ever written into empty buffer, see TranscodeSoundData
+        assert(outputBegin == 0);
+        if (!scratch.vorbisEncoder.Finish(*output))
+          return false;
+
+        outputRecord = VorbisSoundRecord(VorbisHeader(*output), *output);
+        return outputRecord.dataXXH3 != 0;
+      }
+      default: {
+        return false;
+      }
+    }
+  }
+
+private:
+  bool WritePCMS16(const std::span<const int16_t> &input)
+  {
+    const auto *inputBytes = reinterpret_cast<const char *>(input.data());
+    output->insert(output->end(), inputBytes, inputBytes + input.size_bytes());
+    XXH3_64bits_update(TranscodeScratch::Get().GetXXH3State(), input.data(), input.size_bytes());
+    return true;
+  }
+
+  bool WriteADPCM(const std::span<const int16_t> &input)
+  {
+    auto &pendingFrames = TranscodeScratch::Get().pendingFrames;
+    const auto batchSamples = static_cast<size_t>(adpcmEncodeBatchBlocks) * samplesPerBlock * format.channels;
+
+    auto inputIt = input.begin();
+    while (inputIt != input.end())
+    {
+      const auto copiedSamples = std::min<size_t>(batchSamples - pendingFrames.size(), std::distance(inputIt, input.end()));
+      pendingFrames.insert(pendingFrames.end(), inputIt, inputIt + static_cast<ptrdiff_t>(copiedSamples));
+      inputIt += static_cast<ptrdiff_t>(copiedSamples);
+
+      if (pendingFrames.size() == batchSamples)
+        EncodeADPCMBlocks();
+    }
+
+    return true;
+  }
+
+  bool WriteVorbis(const std::span<const int16_t> &input)
+  {
+    return TranscodeScratch::Get().vorbisEncoder.Write(input, *output);
+  }
+
+  void EncodeADPCMBlocks()
+  {
+    auto &scratch = TranscodeScratch::Get();
+    auto &pendingFrames = scratch.pendingFrames;
+    auto &reconstructedFrames = scratch.reconstructedFrames;
+
+    const auto batchFrames = pendingFrames.size() / format.channels;
+    const auto batchOffset = output->size();
+    output->resize(batchOffset + static_cast<size_t>(adpcmEncodeBatchBlocks) * format.blockAlign);
+    const auto batchSize = ADPCMEncodeBlocks(pendingFrames.data(), batchFrames, format.channels, format.blockAlign, output->data() + batchOffset,
+                                             reconstructedFrames.data());
+    output->resize(batchOffset + batchSize);
+
+    XXH3_64bits_update(scratch.GetXXH3State(), reconstructedFrames.data(), batchFrames * format.channels * sizeof(int16_t));
+
+    pendingFrames.clear();
+  }
+
+  // Chosen once in Begin, so blocks of the stream do not go through format switch again.
+  bool (PCMS16BlockWriter::*writeBlock)(const std::span<const int16_t> &) = nullptr;
+  TranscodeFormat format;
+  std::vector<char> *output = nullptr;
+  size_t outputBegin = 0;
+  uint64_t frames = 0;
+  uint32_t samplesPerBlock = 0;
+};
+
+}
+
+TranscodeScratch::~TranscodeScratch()
+{
+  if (xxh3State)
+    XXH3_freeState(xxh3State);
+}
+
+TranscodeScratch &TranscodeScratch::Get()
+{
+  thread_local TranscodeScratch scratch;
+  return scratch;
+}
+
+XXH3_state_t *TranscodeScratch::GetXXH3State()
+{
+  if (!xxh3State)
+    xxh3State = XXH3_createState();
+
+  return xxh3State;
+}
+
+bool PCMS16BlockReader::Open(const AudioDataInfo &soundRecord, const std::span<const char> &soundData)
+{
+  record = soundRecord;
+  data = soundData.subspan(0, std::min<size_t>(soundData.size(), soundRecord.dataSize));
+  decodedData = {};
+  dataOffset = 0;
+  framesLeft = 0;
+  blockFrames = 0;
+  blockFramesOffset = 0;
+  readBlock = nullptr;
+
+  auto &scratch = TranscodeScratch::Get();
+
+  switch (record.format)
+  {
+    case AudioDataFormat::PCM_S16: {
+      if (record.channels == 0 || record.bitsPerSample != 16)
+        return false;
+
+      framesLeft = data.size() / (record.channels * sizeof(int16_t));
+      readBlock = &PCMS16BlockReader::ReadPCMS16;
+      return true;
+    }
+    case AudioDataFormat::IMA_ADPCM: {
+      const auto samplesPerBlock = ADPCMSamplesPerBlock(record.blockAlign, record.channels);
+      if (samplesPerBlock == 0)
+        return false;
+
+      const auto blocksCount = (data.size() + record.blockAlign - 1) / record.blockAlign;
+      framesLeft = blocksCount * samplesPerBlock;
+      if (record.dataSizeUncompressed != 0)
+        framesLeft = std::min<uint64_t>(framesLeft, record.dataSizeUncompressed / (record.channels * sizeof(int16_t)));
+
+      scratch.decodedBlock.resize(static_cast<size_t>(adpcmDecodeBatchBlocks) * samplesPerBlock * record.channels);
+      readBlock = &PCMS16BlockReader::ReadADPCM;
+      return true;
+    }
+    case AudioDataFormat::OGG_VORBIS: {
+      if (!scratch.vorbisDecoder.Open(data))
+        return false;
+
+      record.channels = scratch.vorbisDecoder.GetChannels();
+      record.sampleRate = scratch.vorbisDecoder.GetSampleRate();
+      framesLeft = std::numeric_limits<uint64_t>::max();
+      readBlock = &PCMS16BlockReader::ReadVorbis;
+      return true;
+    }
+    default: {
+      // NOTE - formats without dedicated streaming decoder are decoded at once by the library
+      if (!PCMS16FromSoundData(record, data, scratch.pcms16, AudioConversionFlag::RAWOutput))
+        return false;
+
+      if (record.channels == 0)
+        return false;
+
+      decodedData = scratch.pcms16;
+      framesLeft = decodedData.size() / record.channels;
+      readBlock = &PCMS16BlockReader::ReadDecoded;
+      return true;
+    }
+  }
+}
+
+size_t PCMS16BlockReader::Read(int16_t *frames, const size_t maxFrames)
+{
+  const auto readFrames = static_cast<size_t>(std::min<uint64_t>(maxFrames, framesLeft));
+  if (readFrames == 0 || !readBlock)
+    return 0;
+
+  return (this->*readBlock)(frames, readFrames);
+}
+
+size_t PCMS16BlockReader::ReadPCMS16(int16_t *frames, const size_t readFrames)
+{
+  const auto readBytes = readFrames * record.channels * sizeof(int16_t);
+  std::memcpy(frames, data.data() + dataOffset, readBytes);
+  dataOffset += readBytes;
+  framesLeft -= readFrames;
+  return readFrames;
+}
+
+size_t PCMS16BlockReader::ReadADPCM(int16_t *frames, const size_t readFrames)
+{
+  auto &scratch = TranscodeScratch::Get();
+
+  size_t writtenFrames = 0;
+  while (writtenFrames < readFrames)
+  {
+    if (blockFramesOffset == blockFrames)
+    {
+      const auto batchSize = std::min<size_t>(static_cast<size_t>(adpcmDecodeBatchBlocks) * record.blockAlign, data.size() - dataOffset);
+      blockFrames = static_cast<uint32_t>(ADPCMDecodeBlocks(data.subspan(dataOffset, batchSize), record.blockAlign, record.channels,
+                                                            scratch.decodedBlock.data(), scratch.decodedBlock.size() / record.channels));
+      blockFramesOffset = 0;
+      dataOffset += batchSize;
+
+      if (blockFrames == 0)
+      {
+        framesLeft = 0;
+        break;
+      }
+    }
+
+    const auto copiedFrames = std::min<size_t>(readFrames - writtenFrames, blockFrames - blockFramesOffset);
+    std::memcpy(frames + writtenFrames * record.channels, scratch.decodedBlock.data() + blockFramesOffset * record.channels,
+                copiedFrames * record.channels * sizeof(int16_t));
+    writtenFrames += copiedFrames;
+    blockFramesOffset += static_cast<uint32_t>(copiedFrames);
+  }
+
+  framesLeft -= std::min<uint64_t>(framesLeft, writtenFrames);
+  return writtenFrames;
+}
+
+size_t PCMS16BlockReader::ReadVorbis(int16_t *frames, const size_t readFrames)
+{
+  const auto decodedFrames = TranscodeScratch::Get().vorbisDecoder.Read(frames, readFrames);
+  if (decodedFrames == 0)
+    framesLeft = 0;
+
+  return decodedFrames;
+}
+
+size_t PCMS16BlockReader::ReadDecoded(int16_t *frames, const size_t readFrames)
+{
+  std::memcpy(frames, decodedData.data() + dataOffset, readFrames * record.channels * sizeof(int16_t));
+  dataOffset += readFrames * record.channels;
+  framesLeft -= readFrames;
+  return readFrames;
+}
+
+uint16_t PCMS16BlockReader::GetChannels() const
+{
+  return record.channels;
+}
+
+uint32_t PCMS16BlockReader::GetSampleRate() const
+{
+  return record.sampleRate;
+}
+
+uint64_t PCMS16SoundDataXXH3(const AudioDataInfo &soundRecord, const std::span<const char> &soundData)
+{
+  if (soundRecord.format == AudioDataFormat::PCM_S16)
+    return XXH3_64bits(soundData.data(), std::min<size_t>(soundData.size(), soundRecord.dataSize));
+
+  // NOTE - Vorbis decoders do not have to agree bit by bit, so Vorbis data is always hashed through the library decoder,
+  //        same as Vorbis records loaded from archives and produced by the encoder
+  if (soundRecord.format == AudioDataFormat::OGG_VORBIS)
+    return SoundDataSoundRecord(soundRecord, soundData).dataXXH3;
+
+  PCMS16BlockReader reader;
+  if (!reader.Open(soundRecord, soundData))
+    return 0;
+
+  auto &scratch = TranscodeScratch::Get();
+  auto &decodedFrames = scratch.decodedFrames;
+  decodedFrames.resize(transcodeBlockFrames * reader.GetChannels());
+
+  auto *xxh3State = scratch.GetXXH3State();
+  XXH3_64bits_reset(xxh3State);
+
+  size_t readFrames = 0;
+  while ((readFrames = reader.Read(decodedFrames.data(), transcodeBlockFrames)) != 0)
+    XXH3_64bits_update(xxh3State, decodedFrames.data(), readFrames * reader.GetChannels() * sizeof(int16_t));
+
+  return XXH3_64bits_digest(xxh3State);
+}
+
+bool TranscodeSoundData(const AudioDataInfo &soundRecord, const std::span<const char> &soundData, const TranscodeFormat &targetFormat,
+                        std::vector<char> &output, AudioDataInfo &outputRecord)
+{
+  if (targetFormat.channels == 0 || targetFormat.sampleRate == 0)
+    return false;
+
+  if (targetFormat.format == AudioDataFormat::OGG_VORBIS && !output.empty())
+    return false;
+
+  PCMS16BlockReader reader;
+  if (!reader.Open(soundRecord, soundData))
+    return false;
+
+  const auto inputChannels = reader.GetChannels();
+  const auto inputSampleRate = reader.GetSampleRate();
+  if (inputChannels == 0 || inputSampleRate == 0)
+    return false;
+
+  auto &scratch = TranscodeScratch::Get();
+
+  const auto resample = inputSampleRate != targetFormat.sampleRate;
+  if (resample && !scratch.resampler.Reset(inputSampleRate, targetFormat.sampleRate, targetFormat.channels, targetFormat.resamplerQuality))
+    return false;
+
+  PCMS16BlockWriter writer;
+  if (!writer.Begin(targetFormat, output))
+    return false;
+
+  auto &decodedFrames = scratch.decodedFrames;
+  auto &resampledFrames = scratch.resampledFrames;
+  decodedFrames.resize(transcodeBlockFrames * std::max(inputChannels, targetFormat.channels));
+
+  size_t readFrames = 0;
+  while ((readFrames = reader.Read(decodedFrames.data(), transcodeBlockFrames)) != 0)
+  {
+    PCMS16RemixChannels(decodedFrames.data(), readFrames, inputChannels, targetFormat.channels);
+    std::span<const int16_t> frames{decodedFrames.data(), readFrames * targetFormat.channels};
+
+    if (resample)
+    {
+      resampledFrames.clear();
+      scratch.resampler.Process(frames, resampledFrames);
+      frames = resampledFrames;
+    }
+
+    if (!writer.Write(frames))
+      return false;
+  }
+
+  if (resample)
+  {
+    resampledFrames.clear();
+    scratch.resampler.Flush(resampledFrames);
+
+    if (!writer.Write(resampledFrames))
+      return false;
+  }
+
+  return writer.Finish(outputRecord);
+}
+
+AudioDataInfo HashedSoundRecord(const AudioDataInfo &soundRecord, const std::span<const char> &soundData)
+{
+  if (soundRecord.format != AudioDataFormat::IMA_ADPCM)
+    return SoundDataSoundRecord(soundRecord, soundData);
+
+  auto hashedRecord = soundRecord;
+  hashedRecord.dataXXH3 = PCMS16SoundDataXXH3(soundRecord, soundData);
+  return hashedRecord;
+}
@@ -0,0 +1,96 @@
+//
+// Created by Andrej Redeky.
+// Copyright © 2015-2023 Feldarian Softworks. All rights reserved.
+// SPDX-License-Identifier: EUPL-1.2
+//
+
+#pragma once
+
+#include "Options.hpp"
+#include "Resampler.hpp"
+#include "Vorbis.hpp"
+
+// Number of frames pulled through the transcode pipeline at once.
+inline constexpr size_t transcodeBlockFrames = 4096;
+
+struct TranscodeFormat
+{
+  AudioDataFormat format = AudioDataFormat::PCM_S16;
+  uint32_t sampleRate = 0;
+  uint16_t channels = 0;
+  uint16_t blockAlign = 0; // IMA ADPCM only, derived from channels when 0
+  ResamplerQuality resamplerQuality = ResamplerQuality::BALANCED;
+  VorbisQualityPreset vorbisQuality = VorbisQualityPreset::MEDIUM;
+
+  auto operator<=>(const TranscodeFormat &other) const = default;
+};
+
+// Per-thread scratch buffers used by the import and export transcode paths. Buffers are never shrunk, they are only
+// resized before use, so after the first few files each worker thread stops hitting the heap for intermediate data.
+struct TranscodeScratch
+{
+  ~TranscodeScratch();
+
+  static TranscodeScratch &Get();
+
+  XXH3_state_t *GetXXH3State();
+
+  std::vector<char> input;
+  std::vector<int16_t> pcms16;
+  std::vector<char> encoded;
+
+  std::vector<int16_t> decodedBlock;
+  std::vector<int16_t> decodedFrames;
+  std::vector<int16_t> resampledFrames;
+  std::vector<int16_t> pendingFrames;
+  std::vector<int16_t> reconstructedFrames;
+
+  PCMS16Resampler resampler;
+  VorbisStreamDecoder vorbisDecoder;
+  VorbisStreamEncoder vorbisEncoder;
+
+private:
+  XXH3_state_t *xxh3State = nullptr;
+};
+
+// Reads interleaved PCM S16 frames out of sound data in any supported format, decoding only what is asked for.
+class PCMS16BlockReader
+{
+public:
+  bool Open(const AudioDataInfo &soundRecord, const std::span<const char> &soundData);
+
+  // Returns number of read frames, 0 once the whole stream was read.
+  size_t Read(int16_t *frames, size_t maxFrames);
+
+  uint16_t GetChannels() const;
+  uint32_t GetSampleRate() const;
+
+private:
+  size_t ReadPCMS16(int16_t *frames, size_t readFrames);
+  size_t ReadADPCM(int16_t *frames, size_t readFrames);
+  size_t ReadVorbis(int16_t *frames, size_t readFrames);
+  size_t ReadDecoded(int16_t *frames, size_t readFrames);
+
+  // Chosen once in Open, so blocks of the stream do not go through format switch again.
+  size_t (PCMS16BlockReader::*readBlock)(int16_t *, size_t) = nullptr;
+  AudioDataInfo record{};
+  std::span<const char> data;
+  std::span<const int16_t> decodedData;
+  size_t dataOffset = 0;
+  uint64_t framesLeft = 0;
+  uint32_t blockFrames = 0;
+  uint32_t blockFramesOffset = 0;
+};
+
+// Hash of the PCM S16 data decoded from the sound data, same as hash of whole decoded buffer. Returns 0 on failure.
+// Vorbis data is hashed through the library decoder, so its hashes match records from SoundDataSoundRecord.
+uint64_t PCMS16SoundDataXXH3(const AudioDataInfo &soundRecord, const std::span<const char> &soundData);
+
+// Same as SoundDataSoundRecord, but IMA ADPCM data, which is most of the Glacier 1 sound data, is hashed through
+// vectorized block decoder without decoding whole stream at once.
+AudioDataInfo HashedSoundRecord(const AudioDataInfo &soundRecord, const std::span<const char> &soundData);
+
+// Pulls sound data through decoder, channel remixer, resampler and encoder in blocks of transcodeBlockFrames frames,
+// appending encoded data to the output. Memory used besides the output does not depend on the length of the stream.
+bool TranscodeSoundData(const AudioDataInfo &soundRecord, const std::span<const char> &soundData, const TranscodeFormat &targetFormat,
+                        std::vector<char> &output, AudioDataInfo &outputRecord);
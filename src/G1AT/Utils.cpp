@@ -14,19 +14,28 @@
 
 std::vector<char> ReadWholeBinaryFile(const StringView8CI &acpPath)
 {
+  std::vector<char> result;
+  ReadWholeBinaryFile(acpPath, result);
+  return result;
+}
+
+bool ReadWholeBinaryFile(const StringView8CI &acpPath, std::vector<char> &result)
+{
+  result.clear();
+
   const auto path = acpPath.path();
   if (path.empty() || !exists(path))
-    return {};
+    return false;
 
   const auto oldSync = std::ios_base::sync_with_stdio(false);
 
   std::ifstream file{path, std::ios::binary};
-  std::vector<char> result(file_size(path), 0);
+  result.resize(file_size(path));
   file.read(result.data(), result.size());
 
   std::ios_base::sync_with_stdio(oldSync);
 
-  return result;
+  return !result.empty();
 }
 
 String8 ReadWholeTextFile(const StringView8CI &acpPath)
@@ -48,6 +57,23 @@ String8 ReadWholeTextFile(const StringView8CI &acpPath)
   return result;
 }
 
+bool CopyUnchangedFile(const StringView8CI &acpFromPath, const StringView8CI &acpToPath)
+{
+  if (acpFromPath == acpToPath)
+    return true;
+
+  const auto fromPath = acpFromPath.path();
+  const auto toPath = acpToPath.path();
+  if (fromPath.empty() || toPath.empty())
+    return false;
+
+  std::error_code errorCode;
+  create_directories(toPath.parent_path(), errorCode);
+  copy_file(fromPath, toPath, std::filesystem::copy_options::overwrite_existing, errorCode);
+
+  return !errorCode;
+}
+
 float GetAlignedItemWidth(const int64_t acItemsCount)
 {
   return (ImGui::GetContentRegionAvail().x - static_cast<float>(acItemsCount - 1) * ImGui::GetStyle().ItemSpacing.x) /
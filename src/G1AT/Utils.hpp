@@ -10,8 +10,14 @@
 
 std::vector<char> ReadWholeBinaryFile(const StringView8CI &acpPath);
 
+bool ReadWholeBinaryFile(const StringView8CI &acpPath, std::vector<char> &result);
+
 String8 ReadWholeTextFile(const StringView8CI &acpPath);
 
+// Places file which did not change since it was last written at the new path, letting the file system copy (or share) its blocks.
+// Does nothing when both paths are same, returns false when the caller has to write the file itself.
+bool CopyUnchangedFile(const StringView8CI &acpFromPath, const StringView8CI &acpToPath);
+
 float GetAlignedItemWidth(int64_t acItemsCount);
 
 String8CI BrowseDirectoryDialog();
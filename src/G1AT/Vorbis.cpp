@@ -0,0 +1,326 @@
+//
+// Created by Andrej Redeky.
+// Copyright © 2015-2023 Feldarian Softworks. All rights reserved.
+// SPDX-License-Identifier: EUPL-1.2
+//
+
+#include <Precompiled.hpp>
+
+#include "Vorbis.hpp"
+
+#include <vorbis/vorbisenc.h>
+#include <vorbis/vorbisfile.h>
+
+namespace
+{
+
+constexpr int32_t vorbisStreamSerialNumber = 0x47314154; // 'G1AT', fixed so same input always yields same output
+
+struct VorbisMemorySource
+{
+  std::span<const char> data;
+  size_t offset = 0;
+};
+
+size_t VorbisMemoryRead(void *buffer, const size_t size, const size_t count, void *userData)
+{
+  auto &source = *static_cast<VorbisMemorySource *>(userData);
+  if (size == 0)
+    return 0;
+
+  const auto readCount = std::min(count, (source.data.size() - source.offset) / size);
+  std::memcpy(buffer, source.data.data() + source.offset, readCount * size);
+  source.offset += readCount * size;
+
+  return readCount;
+}
+
+int VorbisMemorySeek(void *userData, const ogg_int64_t offset, const int whence)
+{
+  auto &source = *static_cast<VorbisMemorySource *>(userData);
+
+  int64_t newOffset = offset;
+  if (whence == SEEK_CUR)
+    newOffset += static_cast<int64_t>(source.offset);
+  else if (whence == SEEK_END)
+    newOffset += static_cast<int64_t>(source.data.size());
+
+  if (newOffset < 0 || newOffset > static_cast<int64_t>(source.data.size()))
+    return -1;
+
+  source.offset = static_cast<size_t>(newOffset);
+  return 0;
+}
+
+long VorbisMemoryTell(void *userData)
+{
+  return static_cast<long>(static_cast<VorbisMemorySource *>(userData)->offset);
+}
+
+void AppendOggPage(const ogg_page &page, std::vector<char> &output)
+{
+  output.insert(output.end(), reinterpret_cast<const char *>(page.header), reinterpret_cast<const char *>(page.header) + page.header_len);
+  output.insert(output.end(), reinterpret_cast<const char *>(page.body), reinterpret_cast<const char *>(page.body) + page.body_len);
+}
+
+}
+
+float VorbisQuality(const VorbisQualityPreset preset)
+{
+  switch (preset)
+  {
+    case VorbisQualityPreset::LOW: {
+      return 0.1f;
+    }
+    case VorbisQualityPreset::HIGH: {
+      return 0.7f;
+    }
+    default:
+    case VorbisQualityPreset::MEDIUM: {
+      return 0.4f;
+    }
+  }
+}
+
+struct VorbisStreamDecoder::Context
+{
+  OggVorbis_File file{};
+  VorbisMemorySource source;
+  uint16_t channels = 0;
+  uint32_t sampleRate = 0;
+  bool opened = false;
+};
+
+VorbisStreamDecoder::VorbisStreamDecoder()
+  : context(std::make_unique<Context>())
+{}
+
+VorbisStreamDecoder::~VorbisStreamDecoder()
+{
+  Close();
+}
+
+bool VorbisStreamDecoder::Open(const std::span<const char> &vorbisData)
+{
+  Close();
+
+  context->source = {vorbisData, 0};
+
+  static constexpr ov_callbacks callbacks{VorbisMemoryRead, VorbisMemorySeek, nullptr, VorbisMemoryTell};
+  if (ov_open_callbacks(&context->source, &context->file, nullptr, 0, callbacks) != 0)
+    return false;
+
+  context->opened = true;
+
+  const auto *info = ov_info(&context->file, -1);
+  if (!info || info->channels <= 0 || info->rate <= 0)
+  {
+    Close();
+    return false;
+  }
+
+  context->channels = static_cast<uint16_t>(info->channels);
+  context->sampleRate = static_cast<uint32_t>(info->rate);
+
+  return true;
+}
+
+void VorbisStreamDecoder::Close()
+{
+  if (!context->opened)
+    return;
+
+  ov_clear(&context->file);
+  context->opened = false;
+  context->channels = 0;
+  context->sampleRate = 0;
+}
+
+size_t VorbisStreamDecoder::Read(int16_t *frames, const size_t maxFrames)
+{
+  if (!context->opened)
+    return 0;
+
+  const auto frameSize = context->channels * sizeof(int16_t);
+  auto *outputBytes = reinterpret_cast<char *>(frames);
+  size_t readBytes = 0;
+  while (readBytes < maxFrames * frameSize)
+  {
+    int bitstream = 0;
+    const auto requestedBytes = static_cast<int>(std::min<size_t>(maxFrames * frameSize - readBytes, 0x1000));
+    const auto result = ov_read(&context->file, outputBytes + readBytes, requestedBytes, 0, 2, 1, &bitstream);
+    if (result <= 0)
+      break;
+
+    readBytes += static_cast<size_t>(result);
+  }
+
+  return readBytes / frameSize;
+}
+
+uint16_t VorbisStreamDecoder::GetChannels() const
+{
+  return context->channels;
+}
+
+uint32_t VorbisStreamDecoder::GetSampleRate() const
+{
+  return context->sampleRate;
+}
+
+struct VorbisStreamEncoder::Context
+{
+  vorbis_info info{};
+  vorbis_comment comment{};
+  vorbis_dsp_state dspState{};
+  vorbis_block block{};
+  ogg_stream_state streamState{};
+  uint32_t sampleRate = 0;
+  float quality = 0.0f;
+  uint16_t channels = 0;
+  bool setUp = false;
+  bool began = false;
+};
+
+VorbisStreamEncoder::VorbisStreamEncoder()
+  : context(std::make_unique<Context>())
+{}
+
+VorbisStreamEncoder::~VorbisStreamEncoder()
+{
+  Clear();
+  ClearSetup();
+}
+
+bool VorbisStreamEncoder::Begin(const uint16_t channels, const uint32_t sampleRate, const float quality, std::vector<char> &output)
+{
+  // NOTE - encoder may be left mid-stream by failed transcode, start over in that case
+  Clear();
+
+  if (!context->setUp || context->channels != channels || context->sampleRate != sampleRate || context->quality != quality)
+  {
+    ClearSetup();
+
+    vorbis_info_init(&context->info);
+    if (vorbis_encode_init_vbr(&context->info, channels, static_cast<long>(sampleRate), quality) != 0)
+    {
+      vorbis_info_clear(&context->info);
+      return false;
+    }
+
+    context->channels = channels;
+    context->sampleRate = sampleRate;
+    context->quality = quality;
+    context->setUp = true;
+  }
+
+  vorbis_comment_init(&context->comment);
+  vorbis_analysis_init(&context->dspState, &context->info);
+  vorbis_block_init(&context->dspState, &context->block);
+  ogg_stream_init(&context->streamState, vorbisStreamSerialNumber);
+
+  context->began = true;
+
+  ogg_packet identificationPacket;
+  ogg_packet commentPacket;
+  ogg_packet codebooksPacket;
+  vorbis_analysis_headerout(&context->dspState, &context->comment, &identificationPacket, &commentPacket, &codebooksPacket);
+  ogg_stream_packetin(&context->streamState, &identificationPacket);
+  ogg_stream_packetin(&context->streamState, &commentPacket);
+  ogg_stream_packetin(&context->streamState, &codebooksPacket);
+
+  ogg_page page;
+  while (ogg_stream_flush(&context->streamState, &page) != 0)
+    AppendOggPage(page, output);
+
+  return true;
+}
+
+bool VorbisStreamEncoder::Write(const std::span<const int16_t> &frames, std::vector<char> &output)
+{
+  if (!context->began)
+    return false;
+
+  const auto framesCount = frames.size() / context->channels;
+  if (framesCount == 0)
+    return true;
+
+  auto **buffer = vorbis_analysis_buffer(&context->dspState, static_cast<int>(framesCount));
+  for (size_t frame = 0; frame < framesCount; ++frame)
+  {
+    for (uint16_t channel = 0; channel < context->channels; ++channel)
+      buffer[channel][frame] = static_cast<float>(frames[frame * context->channels + channel]) / 32768.0f;
+  }
+
+  vorbis_analysis_wrote(&context->dspState, static_cast<int>(framesCount));
+
+  return Drain(output);
+}
+
+bool VorbisStreamEncoder::Finish(std::vector<char> &output)
+{
+  if (!context->began)
+    return false;
+
+  // NOTE - writing zero frames marks end of stream for libvorbis
+  vorbis_analysis_wrote(&context->dspState, 0);
+
+  const auto drained = Drain(output);
+  if (drained)
+  {
+    ogg_page page;
+    while (ogg_stream_flush(&context->streamState, &page) != 0)
+      AppendOggPage(page, output);
+  }
+
+  Clear();
+
+  return drained;
+}
+
+void VorbisStreamEncoder::Clear()
+{
+  if (!context->began)
+    return;
+
+  ogg_stream_clear(&context->streamState);
+  vorbis_block_clear(&context->block);
+  vorbis_dsp_clear(&context->dspState);
+  vorbis_comment_clear(&context->comment);
+
+  context->began = false;
+}
+
+void VorbisStreamEncoder::ClearSetup()
+{
+  if (!context->setUp)
+    return;
+
+  vorbis_info_clear(&context->info);
+
+  context->channels = 0;
+  context->sampleRate = 0;
+  context->quality = 0.0f;
+  context->setUp = false;
+}
+
+bool VorbisStreamEncoder::Drain(std::vector<char> &output)
+{
+  ogg_packet packet;
+  ogg_page page;
+  while (vorbis_analysis_blockout(&context->dspState, &context->block) == 1)
+  {
+    if (vorbis_analysis(&context->block, nullptr) != 0 || vorbis_bitrate_addblock(&context->block) != 0)
+      return false;
+
+    while (vorbis_bitrate_flushpacket(&context->dspState, &packet) != 0)
+    {
+      ogg_stream_packetin(&context->streamState, &packet);
+
+      while (ogg_stream_pageout(&context->streamState, &page) != 0)
+        AppendOggPage(page, output);
+    }
+  }
+
+  return true;
+}
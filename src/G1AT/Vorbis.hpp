@@ -0,0 +1,59 @@
+//
+// Created by Andrej Redeky.
+// Copyright © 2015-2023 Feldarian Softworks. All rights reserved.
+// SPDX-License-Identifier: EUPL-1.2
+//
+
+#pragma once
+
+enum class VorbisQualityPreset : uint8_t
+{
+  LOW,
+  MEDIUM,
+  HIGH
+};
+
+// Quality passed to the VBR encoder, roughly 80, 128 and 224 kbps for 44.1 kHz stereo.
+float VorbisQuality(VorbisQualityPreset preset);
+
+// Pulls interleaved PCM S16 frames out of OGG Vorbis data held in memory, block by block.
+class VorbisStreamDecoder
+{
+public:
+  VorbisStreamDecoder();
+  ~VorbisStreamDecoder();
+
+  bool Open(const std::span<const char> &vorbisData);
+  void Close();
+
+  // Returns number of read frames, 0 once the whole stream was read.
+  size_t Read(int16_t *frames, size_t maxFrames);
+
+  uint16_t GetChannels() const;
+  uint32_t GetSampleRate() const;
+
+private:
+  struct Context;
+  std::unique_ptr<Context> context;
+};
+
+// Encodes interleaved PCM S16 frames pushed block by block into OGG Vorbis data. Encoder setup is kept between streams
+// and rebuilt only when channels, sample rate or quality change, so one encoder per thread serves whole batch.
+class VorbisStreamEncoder
+{
+public:
+  VorbisStreamEncoder();
+  ~VorbisStreamEncoder();
+
+  bool Begin(uint16_t channels, uint32_t sampleRate, float quality, std::vector<char> &output);
+  bool Write(const std::span<const int16_t> &frames, std::vector<char> &output);
+  bool Finish(std::vector<char> &output);
+
+private:
+  bool Drain(std::vector<char> &output);
+  void Clear();
+  void ClearSetup();
+
+  struct Context;
+  std::unique_ptr<Context> context;
+};
@@ -42,6 +42,9 @@ inline LocalizationManager g_LocalizationManager{g_GlyphRangesBuilder};
 #include <future>
 #include <iomanip>
 #include <memory>
+#include <mutex>
+#include <numbers>
+#include <numeric>
 #include <shared_mutex>
 #include <sstream>
 #include <string>
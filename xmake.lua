@@ -122,6 +122,7 @@ target("Glacier1AudioTool")
   add_defines("IMGUI_USER_CONFIG=\""..imguiUserConfig.."\"")
 
   --add_defines("G1AT_BUILD_TESTS")
+  --add_defines("G1AT_BUILD_BENCHMARKS")
   --add_defines("G1AT_ENABLE_PROFILING")
 
   add_deps("Glacier1AudioLibrary", "imgui-backends", { private = true })
@@ -186,7 +187,7 @@ target("Glacier1AudioTool")
   set_pcxxheader("src/Precompiled.hpp")
 
   add_syslinks("comdlg32", "opengl32", "shell32")
-  add_packages("scnlib", "libsdl", "imgui", "spdlog", "xxhash", "toml++", "icu4c", "tinyfiledialogs")
+  add_packages("scnlib", "libsdl", "imgui", "spdlog", "xxhash", "libogg", "libvorbis", "toml++", "icu4c", "tinyfiledialogs")
 
   before_build(function (target)
     os.rm(target:targetdir() .. "/data")